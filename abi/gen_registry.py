@@ -0,0 +1,165 @@
+#!/usr/bin/env python3
+"""Generate src/evm_abi_registry.h from JSON ABI descriptions.
+
+Usage: gen_registry.py abi/*.json > src/evm_abi_registry.h
+
+Only state-changing functions are kept, since view and pure functions are
+never signed. Methods are sorted by selector so the app can binary search
+them, and parameter descriptors are deduplicated across the whole registry.
+When two files define the same selector, the first one given wins.
+
+A uint256 is shown as a plain decimal integer unless its input is marked with
+"amount": true, in which case it is shown as a token or GWEI amount.
+"""
+
+import json
+import sys
+
+# Solidity type -> how the app parses and displays it (enum abi_parameter_type)
+SUPPORTED_TYPES = {
+    "address": "ABI_TYPE_ADDRESS",
+    "uint256": "ABI_TYPE_INTEGER",
+    "bytes32": "ABI_TYPE_BYTES32",
+    "bytes": "ABI_TYPE_BYTES",
+    "string": "ABI_TYPE_STRING",
+}
+
+
+def abi_type(parameter):
+    """The C type of an ABI input, or None when the app can't decode it.
+
+    Dynamic arrays of any supported type are decoded too, but not fixed-size
+    or nested arrays, nor tuples.
+    """
+    solidity_type = parameter["type"]
+    array = solidity_type.endswith("[]")
+    if array:
+        solidity_type = solidity_type[:-2]
+    if parameter.get("amount"):
+        if solidity_type != "uint256":
+            raise ValueError("%s: only uint256 can be an amount" % parameter["name"])
+        element = "ABI_TYPE_AMOUNT"
+    else:
+        element = SUPPORTED_TYPES.get(solidity_type)
+    if array:
+        return element and "ABI_ARRAY_OF(%s)" % element
+    return element
+
+# Keccak-256 as used by Ethereum (original padding, not SHA3-256)
+_RC = [
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808A, 0x8000000080008000,
+    0x000000000000808B, 0x0000000080000001, 0x8000000080008081, 0x8000000000008009,
+    0x000000000000008A, 0x0000000000000088, 0x0000000080008009, 0x000000008000000A,
+    0x000000008000808B, 0x800000000000008B, 0x8000000000008089, 0x8000000000008003,
+    0x8000000000008002, 0x8000000000000080, 0x000000000000800A, 0x800000008000000A,
+    0x8000000080008081, 0x8000000000008080, 0x0000000080000001, 0x8000000080008008,
+]
+_ROT = [
+    [0, 36, 3, 41, 18], [1, 44, 10, 45, 2], [62, 6, 43, 15, 61],
+    [28, 55, 25, 21, 56], [27, 20, 39, 8, 14],
+]
+_MASK = (1 << 64) - 1
+
+
+def _rol(x, n):
+    return ((x << n) | (x >> (64 - n))) & _MASK if n else x
+
+
+def _keccak_f(a):
+    for rc in _RC:
+        c = [a[x][0] ^ a[x][1] ^ a[x][2] ^ a[x][3] ^ a[x][4] for x in range(5)]
+        d = [c[(x - 1) % 5] ^ _rol(c[(x + 1) % 5], 1) for x in range(5)]
+        a = [[a[x][y] ^ d[x] for y in range(5)] for x in range(5)]
+        b = [[0] * 5 for _ in range(5)]
+        for x in range(5):
+            for y in range(5):
+                b[y][(2 * x + 3 * y) % 5] = _rol(a[x][y], _ROT[x][y])
+        a = [[b[x][y] ^ (~b[(x + 1) % 5][y] & b[(x + 2) % 5][y]) for y in range(5)] for x in range(5)]
+        a[0][0] ^= rc
+    return a
+
+
+def keccak256(data):
+    rate = 136
+    padded = bytearray(data) + b"\x01"
+    padded += b"\x00" * (-len(padded) % rate)
+    padded[-1] |= 0x80
+    a = [[0] * 5 for _ in range(5)]
+    for off in range(0, len(padded), rate):
+        block = padded[off:off + rate]
+        for i in range(rate // 8):
+            a[i % 5][i // 5] ^= int.from_bytes(block[8 * i:8 * i + 8], "little")
+        a = _keccak_f(a)
+    return b"".join(a[i % 5][i // 5].to_bytes(8, "little") for i in range(4))
+
+
+def c_string(s):
+    return json.dumps(s)
+
+
+def main(paths):
+    methods = {}
+    for path in paths:
+        with open(path) as f:
+            abi = json.load(f)
+        for entry in abi:
+            if entry.get("type") != "function":
+                continue
+            mutability = entry.get("stateMutability", "nonpayable")
+            if mutability in ("view", "pure"):
+                continue
+            name = entry["name"]
+            inputs = entry.get("inputs", [])
+            signature = "%s(%s)" % (name, ",".join(i["type"] for i in inputs))
+            unsupported = [i["type"] for i in inputs if abi_type(i) is None]
+            if unsupported:
+                print("%s: skipping %s: unsupported types %s" % (path, signature, ", ".join(unsupported)), file=sys.stderr)
+                continue
+            selector = keccak256(signature.encode())[:4]
+            if selector in methods:
+                if methods[selector]["signature"] != signature or methods[selector]["inputs"] != inputs:
+                    print("%s: %s shadowed by %s from %s" % (path, signature, methods[selector]["signature"], methods[selector]["path"]), file=sys.stderr)
+                continue
+            methods[selector] = {
+                "path": path,
+                "name": name,
+                "signature": signature,
+                "payable": mutability == "payable",
+                "inputs": inputs,
+            }
+
+    parameters = []
+    for selector in sorted(methods):
+        for i in methods[selector]["inputs"]:
+            p = (i["name"], abi_type(i))
+            if p not in parameters:
+                parameters.append(p)
+    max_parameters = max([len(m["inputs"]) for m in methods.values()] + [1])
+
+    out = sys.stdout
+    out.write("// Generated by abi/gen_registry.py from %s. DO NOT EDIT.\n" % ", ".join(paths))
+    out.write("// Regenerate with `make abi-registry`.\n")
+    out.write("#pragma once\n\n")
+    out.write("#define ABI_MAX_PARAMETERS %d\n\n" % max_parameters)
+    out.write("// X(name, type)\n")
+    out.write("#define ABI_REGISTRY_PARAMETERS(X) \\\n")
+    for name, type_ in parameters:
+        out.write("  X(%s, %s) \\\n" % (c_string(name), type_))
+    out.write("\n")
+    out.write("// X(selector, name, payable, parameter count, parameter indices...), sorted by selector\n")
+    out.write("#define ABI_REGISTRY_METHODS(X) \\\n")
+    for selector in sorted(methods):
+        m = methods[selector]
+        indices = [parameters.index((i["name"], abi_type(i))) for i in m["inputs"]]
+        out.write("  /* %s */ \\\n" % m["signature"])
+        out.write("  X(\"%s\", %s, %s, %d%s) \\\n" % (
+            "".join("\\x%02x" % b for b in selector),
+            c_string(m["name"]),
+            "true" if m["payable"] else "false",
+            len(indices),
+            "".join(", %d" % i for i in indices)))
+    out.write("\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv[1:])
@@ -3,11 +3,15 @@
 #include "to_string.h"
 #include "version.h"
 #include "key_macros.h"
+#include "profile.h"
+#include "trace.h"
 
 #include <stdbool.h>
 #include <stdint.h>
 #include <string.h>
 
+#define CLA 0x80
+#define ETH_CLA 0xe0
 
 size_t provide_address(uint8_t *const io_buffer, public_key_hash_t const *const pubkey_hash) {
     check_null(io_buffer);
@@ -108,26 +112,127 @@ size_t handle_apdu_get_wallet_id(void) {
     return finalize_successful_send(WALLET_ID_LENGTH);
 }
 
+#if defined(STACK_MEASURE) || defined(AVA_PARSE_STATS)
+static size_t write_u16_be(uint8_t *const out, uint16_t const val) {
+    out[0] = val >> 8;
+    out[1] = val;
+    return sizeof(val);
+}
+#endif
+
+#if defined(AVA_PROFILE) || defined(AVA_TRACE) || defined(AVA_PARSE_STATS)
+static size_t write_u32_be(uint8_t *const out, uint32_t const val) {
+    out[0] = val >> 24;
+    out[1] = val >> 16;
+    out[2] = val >> 8;
+    out[3] = val;
+    return sizeof(val);
+}
+#endif
+
 #ifdef STACK_MEASURE
+static bool stack_sentry_filled;
+
 __attribute__((noinline)) void stack_sentry_fill(void) {
   volatile int top;
   top = 5;
   memset((void*)(&app_stack_canary + 1), 42, ((uint8_t*)(&top - 10)) - ((uint8_t*)&app_stack_canary));
+  stack_sentry_filled = true;
 }
 
+// Records the deepest stack use since stack_sentry_fill against the
+// instruction that was handled last. That includes any approval callbacks
+// it left for the following io_exchange, where signing happens.
 void measure_stack_max(void) {
+  if (!stack_sentry_filled) return;
   uint32_t* p;
   volatile int top;
   for (p = &app_stack_canary + 1; p < ((&top) - 10); p++)
     if (*p != 0x2a2a2a2a) {
         PRINTF("Free space between globals and maximum stack: %d\n", 4 * (p - &app_stack_canary));
-        return;
+        break;
+    }
+
+  uint8_t const instruction = global.latest_apdu_instruction;
+  if (instruction >= STACK_STATS_INSTRUCTIONS) return;
+  stack_stats_t *const stats = &global.stack_stats[global.latest_apdu_cla == CLA ? 0 : 1][instruction];
+  stats->last = (uint8_t *)global.stack_root - (uint8_t *)p;
+  if (stats->last > stats->max) stats->max = stats->last;
+}
+
+size_t handle_apdu_diagnostics(void) {
+    size_t tx = 0;
+    tx += write_u16_be(&G_io_apdu_buffer[tx], sizeof(globals_t));
+    tx += write_u16_be(&G_io_apdu_buffer[tx], sizeof(apdu_sign_state_t));
+    tx += write_u16_be(&G_io_apdu_buffer[tx], sizeof(apdu_evm_sign_state_t));
+    G_io_apdu_buffer[tx++] = STACK_STATS_INSTRUCTIONS;
+    for (size_t cla = 0; cla < NUM_ELEMENTS(global.stack_stats); cla++) {
+        for (size_t ins = 0; ins < STACK_STATS_INSTRUCTIONS; ins++) {
+            tx += write_u16_be(&G_io_apdu_buffer[tx], global.stack_stats[cla][ins].last);
+            tx += write_u16_be(&G_io_apdu_buffer[tx], global.stack_stats[cla][ins].max);
+        }
     }
+    return finalize_successful_send(tx);
 }
 #endif
 
-#define CLA 0x80
-#define ETH_CLA 0xe0
+
+#ifdef AVA_PROFILE
+size_t handle_apdu_profile(void) {
+    size_t tx = 0;
+    G_io_apdu_buffer[tx++] = PROFILE_REGION_COUNT;
+    for (size_t i = 0; i < PROFILE_REGION_COUNT; i++) {
+        tx += write_u32_be(&G_io_apdu_buffer[tx], profile_calls[i]);
+    }
+    G_io_apdu_buffer[tx++] = PROFILE_WAIT_COUNT;
+    for (size_t i = 0; i < PROFILE_WAIT_COUNT; i++) {
+        tx += write_u32_be(&G_io_apdu_buffer[tx], profile_wait_ticks[i]);
+    }
+    memset(profile_calls, 0, sizeof(profile_calls));
+    memset(profile_wait_ticks, 0, sizeof(profile_wait_ticks));
+    return finalize_successful_send(tx);
+}
+#endif
+
+#ifdef AVA_TRACE
+#define TRACE_ENTRY_WIRE_SIZE 8
+
+size_t handle_apdu_trace_drain(void) {
+    size_t tx = 0;
+    G_io_apdu_buffer[tx++] = trace_ring.dropped >> 8;
+    G_io_apdu_buffer[tx++] = trace_ring.dropped;
+    trace_ring.dropped = 0;
+
+    size_t const room = (IO_APDU_BUFFER_SIZE - 2 - tx - 1) / TRACE_ENTRY_WIRE_SIZE;
+    size_t const n = MIN((size_t)trace_ring.count, room);
+    G_io_apdu_buffer[tx++] = n;
+    for (size_t i = 0; i < n; i++) {
+        trace_entry_t const *const entry = &trace_ring.entries[trace_ring.head];
+        G_io_apdu_buffer[tx++] = entry->event;
+        G_io_apdu_buffer[tx++] = entry->state;
+        G_io_apdu_buffer[tx++] = entry->offset >> 8;
+        G_io_apdu_buffer[tx++] = entry->offset;
+        tx += write_u32_be(&G_io_apdu_buffer[tx], entry->tick);
+        trace_ring.head = (trace_ring.head + 1) & (TRACE_RING_SIZE - 1);
+        trace_ring.count--;
+    }
+    return finalize_successful_send(tx);
+}
+#endif
+
+#ifdef AVA_PARSE_STATS
+size_t handle_apdu_parse_stats(void) {
+    size_t tx = 0;
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.chunks);
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.min_chunk);
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.max_chunk);
+    tx += write_u32_be(&G_io_apdu_buffer[tx], last_parse_stats.bytes);
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.prompt_flushes);
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.need_more);
+    tx += write_u16_be(&G_io_apdu_buffer[tx], last_parse_stats.resumes);
+    return finalize_successful_send(tx);
+}
+#endif
 
 __attribute__((noreturn)) void main_loop(struct app_handlers const *const app_handlers) {
     uint8_t volatile next_io_exchange_flag = CHANNEL_APDU;
@@ -138,7 +243,12 @@ __attribute__((noreturn)) void main_loop(struct app_handlers const *const app_ha
                 app_stack_canary = 0xdeadbeef;
                 // Process APDU of size rx
 
+                PROFILE_WAIT(next_io_exchange_flag & IO_ASYNCH_REPLY ? PROFILE_WAIT_USER : PROFILE_WAIT_TRANSPORT);
                 size_t const rx = io_exchange(next_io_exchange_flag, next_io_exchange_tx);
+                PROFILE_COUNT(PROFILE_IO);
+#ifdef STACK_MEASURE
+                measure_stack_max();
+#endif
                 next_io_exchange_flag = CHANNEL_APDU;
                 next_io_exchange_tx = 0;
 
@@ -168,6 +278,7 @@ __attribute__((noreturn)) void main_loop(struct app_handlers const *const app_ha
 #endif
 
                 uint8_t const instruction = G_io_apdu_buffer[OFFSET_INS];
+                TRACE(TRACE_APDU_BEGIN, instruction, rx);
 
                 // Don't let state between *different* APDU instructions persist.
                 if (instruction != global.latest_apdu_instruction || cla != global.latest_apdu_cla) {
@@ -187,23 +298,19 @@ __attribute__((noreturn)) void main_loop(struct app_handlers const *const app_ha
 
                 PRINTF("Calling handler\n");
                 size_t const tx = cb();
+                PROFILE_COUNT(PROFILE_HANDLER);
+                TRACE(TRACE_APDU_END, instruction, tx);
                 PRINTF("Normal return\n");
 
                 if (0xdeadbeef != app_stack_canary) {
                     THROW(EXC_STACK_ERROR);
                 }
-#ifdef STACK_MEASURE
-                measure_stack_max();
-#endif
 
                 next_io_exchange_flag = CHANNEL_APDU;
                 next_io_exchange_tx = tx;
             }
             CATCH(ASYNC_EXCEPTION) {
                 PRINTF("Async exception\n");
-#ifdef STACK_MEASURE
-                measure_stack_max();
-#endif
                 next_io_exchange_flag = CHANNEL_APDU | IO_ASYNCH_REPLY;
                 next_io_exchange_tx = 0;
             }
@@ -215,6 +322,7 @@ __attribute__((noreturn)) void main_loop(struct app_handlers const *const app_ha
 
                 uint16_t sw = e;
                 PRINTF("Error caught at top level, number: %x\n", sw);
+                TRACE(TRACE_APDU_ERROR, G_io_apdu_buffer[OFFSET_INS], sw);
                 switch (sw) {
                     default:
                         sw = 0x6800 | (e & 0x7FF);
@@ -4,6 +4,7 @@
 #include "types.h"
 #include "ui.h"
 #include "apdu_sign.h"
+#include "profile.h"
 
 #include <stdbool.h>
 #include <stdint.h>
@@ -44,6 +45,8 @@ static inline size_t finalize_successful_send(size_t tx) {
 
 // Send back response; do not restart the event loop
 static inline void delayed_send(size_t tx) {
+    // Once the prompts are answered, main_loop's io_exchange waits on the host again
+    PROFILE_WAIT(PROFILE_WAIT_TRANSPORT);
     io_exchange(CHANNEL_APDU | IO_RETURN_AFTER_TX, tx);
 }
 
@@ -70,3 +73,19 @@ size_t handle_apdu_get_wallet_id(void);
 size_t handle_apdu_sign_hash(void);
 
 size_t handle_apdu_error(void);
+
+#ifdef STACK_MEASURE
+size_t handle_apdu_diagnostics(void);
+#endif
+
+#ifdef AVA_PROFILE
+size_t handle_apdu_profile(void);
+#endif
+
+#ifdef AVA_TRACE
+size_t handle_apdu_trace_drain(void);
+#endif
+
+#ifdef AVA_PARSE_STATS
+size_t handle_apdu_parse_stats(void);
+#endif
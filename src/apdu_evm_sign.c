@@ -1,9 +1,11 @@
 #include "apdu_sign.h"
 
 #include "apdu.h"
+#include "erc20_cache.h"
 #include "globals.h"
 #include "key_macros.h"
 #include "keys.h"
+#include "key_precompute.h"
 #include "memory.h"
 #include "to_string.h"
 #include "protocol.h"
@@ -18,9 +20,7 @@
 bool evm_sign_ok() {
     uint8_t *const out = G_io_apdu_buffer;
     uint8_t buf[MAX_SIGNATURE_SIZE];
-    size_t const tx = WITH_EXTENDED_KEY_PAIR(G.bip32_path, it, size_t, ({
-        sign(buf, MAX_SIGNATURE_SIZE, &it->key_pair, G.final_hash, sizeof(G.final_hash));
-    }));
+    size_t const tx = sign_with_path(buf, MAX_SIGNATURE_SIZE, &G.bip32_path, G.final_hash, sizeof(G.final_hash));
 
     memcpy(out+1, buf, 64);
 
@@ -34,12 +34,14 @@ bool evm_sign_ok() {
 
 
     memset(&G, 0, sizeof(G));
+    precompute_key_clear();
     delayed_send(finalize_successful_send(tx));
     return true;
 }
 
 static bool evm_sign_reject(void) {
     memset(&G, 0, sizeof(G));
+    precompute_key_clear();
     delay_reject();
     return true; // Return to idle
 }
@@ -66,153 +68,507 @@ void sign_evm_complete() {
 
     register_ui_callback(HASH_INDEX, buffer_to_hex, &G.final_hash_as_buffer);
 
+    precompute_key_arm();
     ui_prompt(transaction_prompts, evm_sign_ok, evm_sign_reject);
 }
 
-static size_t next_parse(bool const is_reentry);
+static enum parse_rv evm_parse(void) {
+    return parse_evm_txn(&G.state, &G.meta_state);
+}
 
-static bool continue_parsing(void) {
-    PRINTF("Continue parsing\n");
-    memset(&G.meta_state.prompt, 0, sizeof(G.meta_state.prompt));
+#ifdef AVA_PARSE_STATS
+static parse_stats_t *evm_stats(void) {
+    return &G.meta_state.stats;
+}
+#endif
 
-    BEGIN_TRY {
-        TRY {
-          // Call next_parse, which calls this function recursively...
-            next_parse(true);
-        }
-        CATCH(ASYNC_EXCEPTION) {
-            // requested another prompt
-            PRINTF("Caught nested ASYNC exception\n");
-        }
-        CATCH_OTHER(e) {
-            THROW(e);
+static prompt_batch_t *evm_prompt(void) {
+    return &G.meta_state.prompt;
+}
+
+static parser_input_meta_state_t *evm_input(void) {
+    return &G.meta_state.input;
+}
+
+static void evm_finish_hash(void) {
+    finish_hash((cx_hash_t *const)&G.tx_hash_state, &G.final_hash);
+    PRINTF("G.final_hash: %.*h\n", sizeof(G.final_hash), G.final_hash);
+}
+
+static sign_session_vtable_t const evm_sign_session = {
+    .parse = evm_parse,
+    .prompt = evm_prompt,
+    .input = evm_input,
+    .finish_hash = evm_finish_hash,
+    .ok = evm_sign_ok,
+    .reject = evm_sign_reject,
+    .preview_reply = NULL,
+    .requires_last_message = false,
+#ifdef AVA_PARSE_STATS
+    .stats = evm_stats,
+#endif
+};
+
+size_t handle_apdu_sign_evm_transaction(void) {
+    uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (in_size > MAX_APDU_SIZE)
+        THROW(EXC_WRONG_LENGTH_FOR_INS);
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+
+    size_t ix = 0;
+
+    switch (p1) {
+      case 0x00: {
+          memset(&G, 0, sizeof(G));
+
+          if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+          ix += read_bip32_path(&G.bip32_path, &in[ix], in_size - ix);
+          check_bip32(&G.bip32_path, false);
+          if (G.bip32_path.length < 3) THROW_(EXC_SECURITY, "Signing path not long enough");
+          precompute_key_request(&G.bip32_path);
+          init_evm_txn(&G.state);
+          cx_keccak_init(&G.tx_hash_state, 256);
+          sign_session_start(&evm_sign_session, false);
+      }
+      fallthrough;
+      case 0x80: {
+          if(in_size == ix) return finalize_successful_send(0);
+
+          PRINTF("HASH BUFFER %.*h\n", in_size - ix, in + ix);
+          cx_hash((cx_hash_t *)&G.tx_hash_state, 0, in + ix, in_size - ix, NULL, 0);
+          PROFILE_COUNT(PROFILE_HASH);
+
+          return sign_session_feed(in + ix, in_size - ix, false);
+      }
+    }
+    return finalize_successful_send(0);
+}
+
+#define PM global.apdu.u.evm_personal_sign
+
+#define P1_PERSONAL_MESSAGE_FIRST 0x00
+#define P1_PERSONAL_MESSAGE_MORE  0x80
+
+static void personal_message_preview_to_string(
+    char out[const], size_t const out_size,
+    apdu_evm_personal_sign_state_t const *const in)
+{
+    size_t ix = 0;
+    if (in->is_text) {
+        if (in->preview_length >= out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit message into prompt value string");
+        for (; ix < in->preview_length; ix++) {
+            out[ix] = in->preview[ix] == '\n' ? ' ' : (char)in->preview[ix];
         }
-        FINALLY {}
+    } else {
+        out[ix++] = '0';
+        out[ix++] = 'x';
+        bin_to_hex_lc(&out[ix], out_size - ix, in->preview, in->preview_length);
+        ix += 2 * in->preview_length;
+    }
+    if (in->length > in->preview_length) {
+        if (ix + 4 > out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+        out[ix++] = '.';
+        out[ix++] = '.';
+        out[ix++] = '.';
     }
-    END_TRY;
+    out[ix] = '\0';
+}
+
+static bool personal_sign_ok(void) {
+    uint8_t *const out = G_io_apdu_buffer;
+    uint8_t buf[MAX_SIGNATURE_SIZE];
+    size_t const tx = sign_with_path(buf, MAX_SIGNATURE_SIZE, &PM.bip32_path, PM.final_hash, sizeof(PM.final_hash));
+
+    // Same v,r,s layout as transactions, with the pre-EIP-155 v
+    out[0] = 27 + (buf[64] & 0x01);
+    memcpy(out+1, buf, 64);
+
+    memset(&PM, 0, sizeof(PM));
+    precompute_key_clear();
+    delayed_send(finalize_successful_send(tx));
     return true;
 }
 
-static void transaction_complete_prompt(void) {
+static bool personal_sign_reject(void) {
+    memset(&PM, 0, sizeof(PM));
+    precompute_key_clear();
+    delay_reject();
+    return true; // Return to idle
+}
+
+__attribute__((noreturn))
+static void personal_sign_complete(void) {
     static uint32_t const TYPE_INDEX = 0;
+    static uint32_t const MESSAGE_INDEX = 1;
 
-    static char const *const transaction_prompts[] = {
-        PROMPT("Finalize"),
+    static char const *const message_prompts[] = {
+        PROMPT("Sign"),
+        PROMPT("Message"),
         NULL,
     };
-    REGISTER_STATIC_UI_VALUE(TYPE_INDEX, "Transaction");
+    REGISTER_STATIC_UI_VALUE(TYPE_INDEX, "Personal Message");
+    register_ui_callback(MESSAGE_INDEX, personal_message_preview_to_string, &PM);
 
-    ui_prompt(transaction_prompts, evm_sign_ok, evm_sign_reject);
+    precompute_key_arm();
+    ui_prompt(message_prompts, personal_sign_ok, personal_sign_reject);
 }
 
-static inline size_t reply_maybe_delayed(bool const is_reentry, size_t const tx) {
-    if (is_reentry) {
-        delayed_send(tx);
+// Hashes the next part of the message, keeping its start for the prompt.
+static void personal_message_update(uint8_t const *const in, size_t const in_size) {
+    if (in_size > PM.remaining) THROW_(EXC_WRONG_LENGTH, "Message longer than its announced length");
+
+    for (size_t i = 0; i < in_size; i++) {
+        if ((in[i] < 0x20 || in[i] > 0x7e) && in[i] != '\n') PM.is_text = false;
     }
-    return tx;
+    size_t const preview = MIN(in_size, sizeof(PM.preview) - PM.preview_length);
+    memcpy(&PM.preview[PM.preview_length], in, preview);
+    PM.preview_length += preview;
+
+    cx_hash((cx_hash_t *)&PM.hash_state, 0, in, in_size, NULL, 0);
+    PROFILE_COUNT(PROFILE_HASH);
+    PM.remaining -= in_size;
 }
 
-static void empty_prompt_queue(void) {
-    if (G.meta_state.prompt.count > 0) {
-        PRINTF("Prompting for %d fields\n", G.meta_state.prompt.count);
+// EIP-191 version 0x45 (personal_sign): the message is streamed in after the
+// path and its 4 byte length, and only its first bytes are kept for display.
+size_t handle_apdu_sign_evm_personal_message(void) {
+    uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (in_size > MAX_APDU_SIZE)
+        THROW(EXC_WRONG_LENGTH_FOR_INS);
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+
+    size_t ix = 0;
 
-        for (size_t i = 0; i < G.meta_state.prompt.count; i++) {
-            register_ui_callback(
-                i,
-                G.meta_state.prompt.entries[i].to_string,
-                &G.meta_state.prompt.entries[i].data
-            );
-        }
-        ui_prompt_with(ASYNC_EXCEPTION, "Next", G.meta_state.prompt.labels, continue_parsing, evm_sign_reject);
-    }
-}
+    switch (p1) {
+      case P1_PERSONAL_MESSAGE_FIRST: {
+          memset(&PM, 0, sizeof(PM));
 
-static size_t next_parse(bool const is_reentry) {
-    PRINTF("Next parse\n");
-    enum parse_rv rv = PARSE_RV_INVALID;
-    BEGIN_TRY {
-      TRY {
-        set_next_batch_size(&G.meta_state.prompt, PROMPT_MAX_BATCH_SIZE);
-        rv = parse_evm_txn(&G.state, &G.meta_state);
-      }
-      FINALLY {
-        switch (rv) {
-        case PARSE_RV_NEED_MORE:
-          break;
-        case PARSE_RV_INVALID:
-          //peek_prompt_queue_reject();
-          //break;
-        case PARSE_RV_PROMPT:
-        case PARSE_RV_DONE:
-          empty_prompt_queue();
+          if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+          ix += read_bip32_path(&PM.bip32_path, &in[ix], in_size - ix);
+          check_bip32(&PM.bip32_path, false);
+          if (PM.bip32_path.length < 3) THROW_(EXC_SECURITY, "Signing path not long enough");
+
+          if (ix + sizeof(uint32_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+          PM.length = CONSUME_UNALIGNED_BIG_ENDIAN(ix, uint32_t, &in[ix]);
+          PM.remaining = PM.length;
+          PM.is_text = true;
+
+          static char const prefix[] = "\x19" "Ethereum Signed Message:\n";
+          char length_digits[MAX_INT_DIGITS + 1];
+          size_t const length_size = number_to_string(length_digits, PM.length);
+          cx_keccak_init(&PM.hash_state, 256);
+          cx_hash((cx_hash_t *)&PM.hash_state, 0, (uint8_t const *)prefix, sizeof(prefix) - 1, NULL, 0);
+          cx_hash((cx_hash_t *)&PM.hash_state, 0, (uint8_t const *)length_digits, length_size, NULL, 0);
+
+          precompute_key_request(&PM.bip32_path);
           break;
-        }
       }
+      case P1_PERSONAL_MESSAGE_MORE:
+          if (PM.remaining == 0) THROW_(EXC_WRONG_PARAM, "Sender broke protocol order by going forward");
+          break;
+      default:
+          THROW(EXC_WRONG_PARAM);
     }
-    END_TRY;
 
-    if ((rv == PARSE_RV_DONE || rv == PARSE_RV_NEED_MORE) &&
-        G.meta_state.input.consumed != G.meta_state.input.length)
-    {
-        PRINTF("Not all input was parsed: %d %d %d\n", rv, G.meta_state.input.consumed, G.meta_state.input.length);
-        THROW(EXC_PARSE_ERROR);
-    }
+    personal_message_update(&in[ix], in_size - ix);
+    if (PM.remaining > 0) return finalize_successful_send(0);
+
+    finish_hash((cx_hash_t *)&PM.hash_state, &PM.final_hash);
+    personal_sign_complete();
+}
+
+#define E global.apdu.u.evm_eip712
+
+#define P1_EIP712_DOMAIN             0x00
+#define P1_EIP712_MESSAGE_CHUNK      0x01
+#define P1_EIP712_MESSAGE_CHUNK_LAST 0x81
+
+#define EIP712_WORD_SIZE 32
+
+// Member declarations of EIP712Domain, in the order of the EIP712_DOMAIN_* bits
+static char const eip712_domain_members[EIP712_DOMAIN_MEMBERS][26] = {
+    "string name",
+    "string version",
+    "uint256 chainId",
+    "address verifyingContract",
+    "bytes32 salt",
+};
+
+static void eip712_hash(void const *const data, size_t const size) {
+    cx_hash((cx_hash_t *)&E.hash_state, 0, data, size, NULL, 0);
+    PROFILE_COUNT(PROFILE_HASH);
+}
+
+static void eip712_hash_to_string(char out[const], size_t const out_size, uint8_t const in[const]) {
+    if (out_size < 2) THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+    out[0] = '0';
+    out[1] = 'x';
+    bin_to_hex_lc(&out[2], out_size - 2, in, SIGN_HASH_SIZE);
+}
+
+static void eip712_address_to_string(char out[const], size_t const out_size, uint8_t const in[const]) {
+    if (out_size < 2) THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+    out[0] = '0';
+    out[1] = 'x';
+    bin_to_hex_lc(&out[2], out_size - 2, in, sizeof(E.verifying_contract));
+}
+
+static void eip712_chain_id_to_string(char out[const], size_t const out_size, uint8_t const in[const]) {
+    uint256_t chain_id;
+    readu256BE(in, &chain_id);
+    if (tostring256(&chain_id, 10, out, out_size) == (size_t)-1) THROW(EXC_WRONG_LENGTH);
+}
+
+static bool eip712_ok(void) {
+    uint8_t *const out = G_io_apdu_buffer;
+    uint8_t buf[MAX_SIGNATURE_SIZE];
+    size_t const tx = sign_with_path(buf, MAX_SIGNATURE_SIZE, &E.bip32_path, E.final_hash, sizeof(E.final_hash));
+
+    out[0] = 27 + (buf[64] & 0x01);
+    memcpy(out+1, buf, 64);
+
+    memset(&E, 0, sizeof(E));
+    precompute_key_clear();
+    delayed_send(finalize_successful_send(tx));
+    return true;
+}
 
-    if (rv == PARSE_RV_NEED_MORE) {
-        PRINTF("Need more\n");
-        return reply_maybe_delayed(is_reentry, finalize_successful_send(0));
+static bool eip712_reject(void) {
+    memset(&E, 0, sizeof(E));
+    precompute_key_clear();
+    delay_reject();
+    return true; // Return to idle
+}
+
+// Neither mode shows the message itself, so typed data is signed blind and
+// follows the sign hash policy: rejected when disallowed, and prompted with the
+// same danger warnings as a hash otherwise.
+static void eip712_check_policy(void) {
+    if (N_data.sign_hash_policy == DISALLOW_ON_SIGN_HASH) {
+        PRINTF("Rejecting due to disallowed sign hash in configuration\n");
+        THROW(EXC_REJECT);
     }
+}
 
-    if (rv == PARSE_RV_DONE) {
-        PRINTF("Parser signaled done; sending final prompt\n");
-        finish_hash((cx_hash_t *const)&G.tx_hash_state, &G.final_hash);
-        PRINTF("G.final_hash: %.*h\n", sizeof(G.final_hash), G.final_hash);
-        transaction_complete_prompt();
+// Hashes "\x19\x01" ‖ domain separator ‖ message hash and asks to sign it.
+__attribute__((noreturn))
+static void eip712_complete(void) {
+    static uint8_t const prefix[] = { 0x19, 0x01 };
+    cx_keccak_init(&E.hash_state, 256);
+    eip712_hash(prefix, sizeof(prefix));
+    eip712_hash(E.domain_separator, sizeof(E.domain_separator));
+    eip712_hash(E.message_hash, sizeof(E.message_hash));
+    finish_hash((cx_hash_t *)&E.hash_state, &E.final_hash);
+
+    bool const warn = N_data.sign_hash_policy == WARN_ON_SIGN_HASH;
+    uint32_t ix = 0;
+    char const *const *prompts;
+    precompute_key_arm();
+    REGISTER_STATIC_UI_VALUE(ix++, "Typed Data");
+    if (warn) REGISTER_STATIC_UI_VALUE(ix++, "YOU MUST verify this manually!!!");
+    if (E.domain_fields == 0) {
+        static char const *const hashed_prompts[] = {
+            PROMPT("Sign"),
+            PROMPT("Domain Hash"),
+            PROMPT("Message Hash"),
+            NULL,
+        };
+        static char const *const hashed_warning_prompts[] = {
+            PROMPT("Sign"),
+            PROMPT("DANGER!"),
+            PROMPT("Domain Hash"),
+            PROMPT("Message Hash"),
+            PROMPT("Are you sure?"),
+            NULL,
+        };
+        prompts = warn ? hashed_warning_prompts : hashed_prompts;
+        register_ui_callback(ix++, eip712_hash_to_string, E.domain_separator);
+    } else {
+        static char const *const streamed_prompts[] = {
+            PROMPT("Sign"),
+            PROMPT("Domain Name"),
+            PROMPT("Domain Chain ID"),
+            PROMPT("Domain Contract"),
+            PROMPT("Message Hash"),
+            NULL,
+        };
+        static char const *const streamed_warning_prompts[] = {
+            PROMPT("Sign"),
+            PROMPT("DANGER!"),
+            PROMPT("Domain Name"),
+            PROMPT("Domain Chain ID"),
+            PROMPT("Domain Contract"),
+            PROMPT("Message Hash"),
+            PROMPT("Are you sure?"),
+            NULL,
+        };
+        prompts = warn ? streamed_warning_prompts : streamed_prompts;
+        if (E.domain_fields & EIP712_DOMAIN_NAME) {
+            register_ui_callback(ix++, copy_string, E.name);
+        } else {
+            REGISTER_STATIC_UI_VALUE(ix++, "Not in domain");
+        }
+        if (E.domain_fields & EIP712_DOMAIN_CHAIN_ID) {
+            register_ui_callback(ix++, eip712_chain_id_to_string, E.chain_id);
+        } else {
+            REGISTER_STATIC_UI_VALUE(ix++, "Not in domain");
+        }
+        if (E.domain_fields & EIP712_DOMAIN_VERIFYING_CONTRACT) {
+            register_ui_callback(ix++, eip712_address_to_string, E.verifying_contract);
+        } else {
+            REGISTER_STATIC_UI_VALUE(ix++, "Not in domain");
+        }
     }
+    register_ui_callback(ix++, eip712_hash_to_string, E.message_hash);
+    if (warn) REGISTER_STATIC_UI_VALUE(ix++, "This is very dangerous!");
+    ui_prompt(prompts, eip712_ok, eip712_reject);
+}
 
-    PRINTF("Parse error: rv=%d consumed=%d length=%d\n",
-      rv,
-      G.meta_state.input.consumed,
-      G.meta_state.input.length);
-    THROW(EXC_PARSE_ERROR);
+static size_t eip712_read_path(uint8_t const *const in, size_t const in_size) {
+    if (in_size < sizeof(uint8_t)) THROW_(EXC_WRONG_LENGTH, "Input too small");
+    size_t const ix = read_bip32_path(&E.bip32_path, in, in_size);
+    check_bip32(&E.bip32_path, false);
+    if (E.bip32_path.length < 3) THROW_(EXC_SECURITY, "Signing path not long enough");
+    precompute_key_request(&E.bip32_path);
+    return ix;
 }
 
-size_t handle_apdu_sign_evm_transaction(void) {
+// Path ‖ domain separator ‖ message hash, as sent by hw-app-eth's signEIP712HashedMessage.
+size_t handle_apdu_sign_evm_eip712_hashed(void) {
+    eip712_check_policy();
+
     uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
     uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
     if (in_size > MAX_APDU_SIZE)
         THROW(EXC_WRONG_LENGTH_FOR_INS);
-    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
 
+    memset(&E, 0, sizeof(E));
+    size_t ix = eip712_read_path(in, in_size);
+
+    if (ix + sizeof(E.domain_separator) + sizeof(E.message_hash) != in_size) THROW_(EXC_WRONG_LENGTH, "Expected two hashes after the path");
+    memcpy(E.domain_separator, &in[ix], sizeof(E.domain_separator));
+    ix += sizeof(E.domain_separator);
+    memcpy(E.message_hash, &in[ix], sizeof(E.message_hash));
+
+    eip712_complete();
+}
+
+// The domain is a mask of EIP712_DOMAIN_* bits followed by each present
+// member's encoding: name as a length byte and up to 32 printable ASCII
+// characters, the Keccak-256 hash of version, chainId and salt as words, and
+// the 20 bytes of verifyingContract. Its type hash and separator are computed
+// here, so the name, chain ID and contract shown are the ones that get signed.
+static void eip712_read_domain(uint8_t const *const in, size_t const in_size) {
     size_t ix = 0;
+    if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+    E.domain_fields = in[ix++];
+    if (E.domain_fields == 0 || E.domain_fields >= (1 << EIP712_DOMAIN_MEMBERS))
+        THROW_(EXC_WRONG_PARAM, "Invalid EIP-712 domain members");
+
+    uint8_t name_hash[SIGN_HASH_SIZE];
+    if (E.domain_fields & EIP712_DOMAIN_NAME) {
+        if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+        size_t const name_length = in[ix++];
+        if (name_length > EIP712_DOMAIN_NAME_MAX_LENGTH) THROW_(EXC_WRONG_LENGTH, "Domain name too long");
+        if (ix + name_length > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+        for (size_t i = 0; i < name_length; i++) {
+            if (in[ix + i] < 0x20 || in[ix + i] > 0x7e) THROW_(EXC_WRONG_PARAM, "Domain name must be printable ASCII");
+        }
+        memcpy(E.name, &in[ix], name_length);
+        E.name[name_length] = '\0';
+        cx_keccak_init(&E.hash_state, 256);
+        eip712_hash(&in[ix], name_length);
+        finish_hash((cx_hash_t *)&E.hash_state, &name_hash);
+        ix += name_length;
+    }
 
-    switch (p1) {
-      case 0x00: {
-          memset(&G, 0, sizeof(G));
+    static char const type_start[] = "EIP712Domain(";
+    static char const type_separator[] = ",";
+    static char const type_end[] = ")";
+    uint8_t type_hash[SIGN_HASH_SIZE];
+    cx_keccak_init(&E.hash_state, 256);
+    eip712_hash(type_start, sizeof(type_start) - 1);
+    bool first = true;
+    for (size_t i = 0; i < EIP712_DOMAIN_MEMBERS; i++) {
+        if (!(E.domain_fields & (1 << i))) continue;
+        if (!first) eip712_hash(type_separator, sizeof(type_separator) - 1);
+        eip712_hash(eip712_domain_members[i], strlen(eip712_domain_members[i]));
+        first = false;
+    }
+    eip712_hash(type_end, sizeof(type_end) - 1);
+    finish_hash((cx_hash_t *)&E.hash_state, &type_hash);
+
+    static uint8_t const address_padding[EIP712_WORD_SIZE - sizeof(E.verifying_contract)] = { 0 };
+    cx_keccak_init(&E.hash_state, 256);
+    eip712_hash(type_hash, sizeof(type_hash));
+    for (size_t i = 0; i < EIP712_DOMAIN_MEMBERS; i++) {
+        uint8_t const field = 1 << i;
+        if (!(E.domain_fields & field)) continue;
+        if (field == EIP712_DOMAIN_NAME) {
+            eip712_hash(name_hash, sizeof(name_hash));
+            continue;
+        }
+        size_t const size = field == EIP712_DOMAIN_VERIFYING_CONTRACT ? sizeof(E.verifying_contract) : EIP712_WORD_SIZE;
+        if (ix + size > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+        if (field == EIP712_DOMAIN_CHAIN_ID) memcpy(E.chain_id, &in[ix], size);
+        if (field == EIP712_DOMAIN_VERIFYING_CONTRACT) {
+            memcpy(E.verifying_contract, &in[ix], size);
+            eip712_hash(address_padding, sizeof(address_padding));
+        }
+        eip712_hash(&in[ix], size);
+        ix += size;
+    }
+    if (ix != in_size) THROW_(EXC_WRONG_LENGTH, "Unexpected bytes after the domain");
+    finish_hash((cx_hash_t *)&E.hash_state, &E.domain_separator);
+}
 
-          if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
-          ix += read_bip32_path(&G.bip32_path, &in[ix], in_size - ix);
-          check_bip32(&G.bip32_path, false);
-          if (G.bip32_path.length < 3) THROW_(EXC_SECURITY, "Signing path not long enough");
-          init_evm_txn(&G.state);
-          cx_keccak_init(&G.tx_hash_state, 256);
-      }
-      fallthrough;
-      case 0x80: {
-          G.meta_state.input.src = in+ix;
-          G.meta_state.input.consumed=0;
-          G.meta_state.input.length=in_size-ix;
-          if(G.meta_state.input.length == 0) return finalize_successful_send(0);
+// P1 0x00 carries the path and the domain. The message then follows in
+// chunks (P1 0x01, and 0x81 for the last) as its hashStruct encoding: the
+// type hash and one word per member, with dynamic and struct members
+// already hashed by the sender. Only one Keccak state is ever held.
+size_t handle_apdu_sign_evm_eip712_streamed(void) {
+    eip712_check_policy();
 
-          PRINTF("HASH BUFFER %.*h\n", G.meta_state.input.length, G.meta_state.input.src);
-          cx_hash((cx_hash_t *)&G.tx_hash_state, 0, G.meta_state.input.src, G.meta_state.input.length, NULL, 0);
+    uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (in_size > MAX_APDU_SIZE)
+        THROW(EXC_WRONG_LENGTH_FOR_INS);
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
 
-          return next_parse(false);
+    switch (p1) {
+      case P1_EIP712_DOMAIN: {
+          memset(&E, 0, sizeof(E));
+          size_t const ix = eip712_read_path(in, in_size);
+          eip712_read_domain(&in[ix], in_size - ix);
+          cx_keccak_init(&E.hash_state, 256);
+          E.awaiting_message = true;
+          return finalize_successful_send(0);
       }
+      case P1_EIP712_MESSAGE_CHUNK:
+      case P1_EIP712_MESSAGE_CHUNK_LAST:
+          if (!E.awaiting_message) THROW_(EXC_WRONG_PARAM, "Sender broke protocol order by going forward");
+          eip712_hash(in, in_size);
+          E.message_length += in_size;
+          if (p1 == P1_EIP712_MESSAGE_CHUNK) return finalize_successful_send(0);
+
+          if (E.message_length < EIP712_WORD_SIZE || E.message_length % EIP712_WORD_SIZE != 0)
+              THROW_(EXC_WRONG_LENGTH, "Message must be a type hash followed by whole words");
+          E.awaiting_message = false;
+          finish_hash((cx_hash_t *)&E.hash_state, &E.message_hash);
+          eip712_complete();
+      default:
+          THROW(EXC_WRONG_PARAM);
     }
-    return finalize_successful_send(0);
 }
 
 size_t handle_apdu_provide_erc20(void) {
+    uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (in_size > MAX_APDU_SIZE)
+        THROW(EXC_WRONG_LENGTH_FOR_INS);
+
+    erc20_cache_provide(in, in_size);
     return finalize_successful_send(0);
 }
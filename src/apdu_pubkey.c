@@ -6,6 +6,7 @@
 #include "keys.h"
 #include "key_macros.h"
 #include "protocol.h"
+#include "pubkey_cache.h"
 #include "to_string.h"
 #include "ui.h"
 
@@ -53,15 +54,16 @@ size_t handle_apdu_get_public_key_impl(bool const prompt_ext) {
     }
 
     read_bip32_path(&G.bip32_path, bip32_path, cdata_size);
-    generate_extended_public_key(&G.ext_public_key, &G.bip32_path);
-    generate_pkh_for_pubkey(&G.ext_public_key.public_key, &G.pkh);
+    // Check before the lookup so that rejected paths never reach the cache.
+    check_bip32(&G.bip32_path, !prompt_ext);
+    cached_public_key_t const *const cached = cached_public_key(&G.bip32_path);
+    memcpy(&G.ext_public_key, &cached->ext_public_key, sizeof(G.ext_public_key));
+    memcpy(&G.pkh, &cached->avm_pkh, sizeof(G.pkh));
     PRINTF("public key hash: %.*h\n", 20, G.pkh);
 
     if (prompt_ext) {
-        check_bip32(&G.bip32_path, false);
         return ext_pubkey_ok();
     } else {
-        check_bip32(&G.bip32_path, true);
         return address_ok();
     }
 }
@@ -82,13 +84,13 @@ size_t handle_apdu_evm_get_address(void) {
     }
 
     read_bip32_path(&G.bip32_path, buffer+OFFSET_CDATA, cdata_size);
-    generate_extended_public_key(&G.ext_public_key, &G.bip32_path);
-
-    generate_evm_pkh_for_pubkey(&G.ext_public_key.public_key, &G.pkh);
+    check_bip32(&G.bip32_path, false);
+    cached_public_key_t const *const cached = cached_public_key(&G.bip32_path);
+    memcpy(&G.ext_public_key, &cached->ext_public_key, sizeof(G.ext_public_key));
+    memcpy(&G.pkh, &cached->evm_pkh, sizeof(G.pkh));
 
     G.type = PUBKEY_STATE_EVM;
 
-    check_bip32(&G.bip32_path, false);
     return address_ok();
 }
 
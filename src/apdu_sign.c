@@ -4,9 +4,11 @@
 #include "globals.h"
 #include "key_macros.h"
 #include "keys.h"
+#include "key_precompute.h"
 #include "memory.h"
 #include "to_string.h"
 #include "protocol.h"
+#include "pubkey_cache.h"
 #include "ui.h"
 #include "cx.h"
 #include "hash.h"
@@ -18,6 +20,7 @@
 static inline void clear_data(void) {
     PRINTF("Clearing sign APDU state\n");
     memset(&G, 0, sizeof(G));
+    precompute_key_clear();
 }
 
 static bool sign_ok(void) {
@@ -68,6 +71,7 @@ static size_t sign_hash_complete(void) {
 
         REGISTER_STATIC_UI_VALUE(ARE_YOU_SURE_INDEX, "This is very dangerous!");
 
+        precompute_key_arm();
         ui_prompt(transaction_prompts, sign_ok, sign_reject);
     } else { // no warnings
         static uint32_t const TYPE_INDEX = 0;
@@ -86,6 +90,7 @@ static size_t sign_hash_complete(void) {
 
         register_ui_callback(HASH_INDEX, buffer_to_hex, &G.final_hash_as_buffer);
 
+        precompute_key_arm();
         ui_prompt(transaction_prompts, sign_ok, sign_reject);
     }
 
@@ -115,9 +120,7 @@ static size_t sign_hash_with_suffix(uint8_t *const out, bool const is_last_signa
     print_ava_debug(bip32_path);
 #endif
 
-    size_t const tx = WITH_EXTENDED_KEY_PAIR(bip32_path, it, size_t, ({
-        sign(out, MAX_SIGNATURE_SIZE, &it->key_pair, G.final_hash, sizeof(G.final_hash));
-    }));
+    size_t const tx = sign_with_path(out, MAX_SIGNATURE_SIZE, &bip32_path, G.final_hash, sizeof(G.final_hash));
 
     if (G.num_signatures_left == 0) {
         clear_data();
@@ -153,6 +156,7 @@ static size_t sign_hash_impl(
         if (G.bip32_path_prefix.length < 3) THROW(EXC_SECURITY);
 
         PRINTF("First signing message: requested_num_signatures = %d\n", G.requested_num_signatures);
+        precompute_key_request(&G.bip32_path_prefix);
 
         return sign_hash_complete();
     } else {
@@ -187,118 +191,44 @@ size_t handle_apdu_sign_hash(void) {
     return sign_hash_impl(buff, buff_size, isFirstMessage, isLastMessage);
 }
 
-static size_t next_parse(bool const is_reentry);
-
-static bool continue_parsing(void) {
-    PRINTF("Continue parsing\n");
-    memset(&G.parser.meta_state.prompt, 0, sizeof(G.parser.meta_state.prompt));
-
-    BEGIN_TRY {
-        TRY {
-          // Call next_parse, which calls this function recursively...
-            next_parse(true);
-        }
-        CATCH(ASYNC_EXCEPTION) {
-            // requested another prompt
-            PRINTF("Caught nested ASYNC exception\n");
-        }
-        CATCH_OTHER(e) {
-            THROW(e);
-        }
-        FINALLY {}
-    }
-    END_TRY;
-    return true;
+static enum parse_rv avm_parse(void) {
+    return parseTransaction(&G.parser.state, &G.parser.meta_state);
 }
 
-static void transaction_complete_prompt(void) {
-    static uint32_t const TYPE_INDEX = 0;
-
-    static char const *const transaction_prompts[] = {
-        PROMPT("Finalize"),
-        NULL,
-    };
-    REGISTER_STATIC_UI_VALUE(TYPE_INDEX, "Transaction");
-
-    ui_prompt(transaction_prompts, sign_ok, sign_reject);
+static prompt_batch_t *avm_prompt(void) {
+    return &G.parser.meta_state.prompt;
 }
 
-static inline size_t reply_maybe_delayed(bool const is_reentry, size_t const tx) {
-    if (is_reentry) {
-        delayed_send(tx);
-    }
-    return tx;
+static parser_input_meta_state_t *avm_input(void) {
+    return &G.parser.meta_state.input;
 }
 
-static void empty_prompt_queue(void) {
-    if (G.parser.meta_state.prompt.count > 0) {
-        PRINTF("Prompting for %d fields\n", G.parser.meta_state.prompt.count);
-
-        for (size_t i = 0; i < G.parser.meta_state.prompt.count; i++) {
-            register_ui_callback(
-                i,
-                G.parser.meta_state.prompt.entries[i].to_string,
-                &G.parser.meta_state.prompt.entries[i].data
-            );
-        }
-        ui_prompt_with(ASYNC_EXCEPTION, "Next", G.parser.meta_state.prompt.labels, continue_parsing, sign_reject);
-    }
+#ifdef AVA_PARSE_STATS
+static parse_stats_t *avm_stats(void) {
+    return &G.parser.meta_state.stats;
 }
+#endif
 
-static size_t next_parse(bool const is_reentry) {
-    PRINTF("Next parse\n");
-    enum parse_rv rv = PARSE_RV_INVALID;
-    BEGIN_TRY {
-      TRY {
-        set_next_batch_size(&G.parser.meta_state.prompt, PROMPT_MAX_BATCH_SIZE);
-        rv = parseTransaction(&G.parser.state, &G.parser.meta_state);
-      }
-      FINALLY {
-        switch (rv) {
-        case PARSE_RV_NEED_MORE:
-          break;
-        case PARSE_RV_INVALID:
-        case PARSE_RV_PROMPT:
-        case PARSE_RV_DONE:
-          empty_prompt_queue();
-          break;
-        }
-      }
-    }
-    END_TRY;
-
-    if ((rv == PARSE_RV_DONE || rv == PARSE_RV_NEED_MORE) &&
-        G.parser.meta_state.input.consumed != G.parser.meta_state.input.length)
-    {
-        PRINTF("Not all input was parsed: %d %d %d\n", rv, G.parser.meta_state.input.consumed, G.parser.meta_state.input.length);
-        THROW(EXC_PARSE_ERROR);
-    }
-
-    if (rv == PARSE_RV_NEED_MORE) {
-        if (G.parser.is_last_message) {
-            PRINTF("Sender claimed last message and we aren't done\n");
-            THROW(EXC_PARSE_ERROR);
-        }
-        PRINTF("Need more\n");
-        return reply_maybe_delayed(is_reentry, finalize_successful_send(0));
-    }
-
-    if (rv == PARSE_RV_DONE) {
-        if (!G.parser.is_last_message) {
-            PRINTF("Sender claims there is more but we are done\n");
-            THROW(EXC_PARSE_ERROR);
-        }
-
-        PRINTF("Parser signaled done; sending final prompt\n");
-        finish_hash((cx_hash_t *const)&G.parser.state.hash_state, &G.final_hash);
-        transaction_complete_prompt();
-    }
-
-
-    PRINTF("Parse error: %d %d %d\n", rv, G.parser.meta_state.input.consumed, G.parser.meta_state.input.length);
-    THROW(EXC_PARSE_ERROR);
+static void avm_finish_hash(void) {
+    finish_hash((cx_hash_t *const)&G.parser.state.hash_state, &G.final_hash);
 }
 
+static size_t preview_summary(void);
+
+static sign_session_vtable_t const avm_sign_session = {
+    .parse = avm_parse,
+    .prompt = avm_prompt,
+    .input = avm_input,
+    .finish_hash = avm_finish_hash,
+    .ok = sign_ok,
+    .reject = sign_reject,
+    .preview_reply = preview_summary,
+    .requires_last_message = true,
+#ifdef AVA_PARSE_STATS
+    .stats = avm_stats,
+#endif
+};
+
 #define SIGN_TRANSACTION_SECTION_PREAMBLE            0x00
 #define SIGN_TRANSACTION_SECTION_PAYLOAD_CHUNK       0x01
 #define SIGN_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST  0x81
@@ -317,9 +247,8 @@ void __attribute__ ((noinline)) handle_has_change_path(size_t ix, uint8_t const
     }
 
     check_bip32(&change_path, true);
-    extended_public_key_t ext_public_key;
-    generate_extended_public_key(&ext_public_key, &change_path);
-    generate_pkh_for_pubkey(&ext_public_key.public_key, &G.change_address);
+    cached_public_key_t const *const cached = cached_public_key(&change_path);
+    memcpy(&G.change_address, &cached->avm_pkh, sizeof(G.change_address));
 }
 
 size_t handle_apdu_sign_transaction(void) {
@@ -343,12 +272,14 @@ size_t handle_apdu_sign_transaction(void) {
             ix += read_bip32_path(&G.bip32_path_prefix, &in[ix], in_size - ix);
             check_bip32(&G.bip32_path_prefix, false);
             if (G.bip32_path_prefix.length < 3) THROW_(EXC_SECURITY, "Signing prefix path not long enough");
+            precompute_key_request(&G.bip32_path_prefix);
 
             if (hasChangePath) {
                 handle_has_change_path(ix, in, in_size);
             }
 
             initTransaction(&G.parser.state);
+            sign_session_start(&avm_sign_session, false);
             return finalize_successful_send(0);
         }
 
@@ -356,11 +287,7 @@ size_t handle_apdu_sign_transaction(void) {
         case SIGN_TRANSACTION_SECTION_PAYLOAD_CHUNK:
             if (G.num_signatures_left > 0) THROW_(EXC_SECURITY, "Sender broke protocol order by going backward");
             if (G.requested_num_signatures == 0) THROW_(EXC_WRONG_PARAM, "Sender broke protocol order by going forward");
-            G.parser.is_last_message = p1 == SIGN_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST;
-            G.parser.meta_state.input.consumed = 0;
-            G.parser.meta_state.input.src = in;
-            G.parser.meta_state.input.length = in_size;
-            return next_parse(false);
+            return sign_session_feed(in, in_size, p1 == SIGN_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST);
 
         case SIGN_TRANSACTION_SECTION_SIGN_WITH_PATH_LAST:
         case SIGN_TRANSACTION_SECTION_SIGN_WITH_PATH:
@@ -371,3 +298,61 @@ size_t handle_apdu_sign_transaction(void) {
         default: THROW_(EXC_WRONG_PARAM, "Unrecognized P1 %d", p1);
     }
 }
+
+#define PREVIEW_TRANSACTION_SECTION_PREAMBLE           0x00
+#define PREVIEW_TRANSACTION_SECTION_PAYLOAD_CHUNK      0x01
+#define PREVIEW_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST 0x81
+
+static size_t write_u64_be(uint8_t *const out, uint64_t const val) {
+    for (size_t i = 0; i < sizeof(val); i++) {
+        out[i] = (uint8_t)(val >> (8 * (sizeof(val) - i - 1)));
+    }
+    return sizeof(val);
+}
+
+// Summary layout: type id (4 bytes BE), chain (1 byte), sum of inputs, sum of
+// outputs, fee, staked (8 bytes BE each), then the 32 byte transaction hash.
+static size_t preview_summary(void) {
+    uint64_t fee;
+    if (__builtin_usubll_overflow(G.parser.meta_state.sum_of_inputs, G.parser.meta_state.sum_of_outputs, &fee))
+        THROW_(EXC_MEMORY_ERROR, "Difference of outputs from inputs overflowed");
+
+    size_t tx = 0;
+    uint32_t const type_id = G.parser.meta_state.raw_type_id;
+    G_io_apdu_buffer[tx++] = (uint8_t)(type_id >> 24);
+    G_io_apdu_buffer[tx++] = (uint8_t)(type_id >> 16);
+    G_io_apdu_buffer[tx++] = (uint8_t)(type_id >> 8);
+    G_io_apdu_buffer[tx++] = (uint8_t)type_id;
+    G_io_apdu_buffer[tx++] = (uint8_t)G.parser.meta_state.chain;
+    tx += write_u64_be(&G_io_apdu_buffer[tx], G.parser.meta_state.sum_of_inputs);
+    tx += write_u64_be(&G_io_apdu_buffer[tx], G.parser.meta_state.sum_of_outputs);
+    tx += write_u64_be(&G_io_apdu_buffer[tx], fee);
+    tx += write_u64_be(&G_io_apdu_buffer[tx], G.parser.meta_state.staked);
+    memcpy(&G_io_apdu_buffer[tx], G.final_hash, sizeof(G.final_hash));
+    tx += sizeof(G.final_hash);
+
+    clear_data();
+    return tx;
+}
+
+size_t handle_apdu_preview_transaction(void) {
+    uint8_t const *const in = &G_io_apdu_buffer[OFFSET_CDATA];
+    uint8_t const in_size = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_LC]);
+    if (in_size > MAX_APDU_SIZE)
+        THROW(EXC_WRONG_LENGTH_FOR_INS);
+    uint8_t const p1 = READ_UNALIGNED_BIG_ENDIAN(uint8_t, &G_io_apdu_buffer[OFFSET_P1]);
+
+    switch (p1) {
+        case PREVIEW_TRANSACTION_SECTION_PREAMBLE:
+            clear_data();
+            initTransaction(&G.parser.state);
+            sign_session_start(&avm_sign_session, true);
+            return finalize_successful_send(0);
+
+        case PREVIEW_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST:
+        case PREVIEW_TRANSACTION_SECTION_PAYLOAD_CHUNK:
+            return sign_session_feed(in, in_size, p1 == PREVIEW_TRANSACTION_SECTION_PAYLOAD_CHUNK_LAST);
+
+        default: THROW_(EXC_WRONG_PARAM, "Unrecognized P1 %d", p1);
+    }
+}
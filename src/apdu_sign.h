@@ -4,5 +4,9 @@
 
 size_t handle_apdu_sign_hash(void);
 size_t handle_apdu_sign_transaction(void);
+size_t handle_apdu_preview_transaction(void);
 size_t handle_apdu_sign_evm_transaction(void);
+size_t handle_apdu_sign_evm_personal_message(void);
+size_t handle_apdu_sign_evm_eip712_hashed(void);
+size_t handle_apdu_sign_evm_eip712_streamed(void);
 size_t handle_apdu_provide_erc20(void);
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "parser.h"
+
+// Field descriptors for the table-driven codec interpreter in parser.c.
+// The tables themselves are generated from codec_schema.h.
+
+enum codec_field_kind {
+    CODEC_END = 0,
+    CODEC_U16,
+    CODEC_U32,
+    CODEC_U64,
+    CODEC_ID32,
+    CODEC_ADDRESS,
+    CODEC_ARRAY,
+    CODEC_STRUCT,
+    CODEC_VARIANT,
+    CODEC_SKIP,
+};
+
+typedef enum parse_rv (*codec_hook_t)(struct codec_state *const state, parser_meta_state_t *const meta);
+
+struct codec_variant {
+    uint32_t type_id;
+    struct codec_field const *schema;
+};
+
+struct codec_field {
+    enum codec_field_kind kind;
+    codec_hook_t hook;
+    void const *sub; // STRUCT: schema; VARIANT: codec_variant table ending in a NULL schema
+#ifdef CODEC_HOST_ENCODER
+    char const *name;
+#endif
+};
+
+#ifdef CODEC_HOST_ENCODER
+#define CODEC_FIELD_NAME_(name_) .name = #name_,
+#else
+#define CODEC_FIELD_NAME_(name_)
+#endif
+
+#define CODEC_FIELD(kind_, name_, hook_) { .kind = (kind_), .hook = (hook_), .sub = NULL, CODEC_FIELD_NAME_(name_) }
+#define CODEC_NESTED(kind_, name_, sub_, hook_) { .kind = (kind_), .hook = (hook_), .sub = (sub_), CODEC_FIELD_NAME_(name_) }
+#define CODEC_FIELDS_END { .kind = CODEC_END, .hook = NULL, .sub = NULL }
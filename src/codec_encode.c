@@ -0,0 +1,152 @@
+#ifdef CODEC_HOST_ENCODER
+
+#include "codec_encode.h"
+
+#include <string.h>
+
+#define CODEC_HOOK(hook) NULL
+CODEC_DEFINE_SCHEMAS()
+#undef CODEC_HOOK
+
+static uint8_t *reserve(struct codec_encoder *const enc, size_t const len) {
+    if (enc->overflowed || len > enc->size - enc->len) {
+        enc->overflowed = true;
+        return NULL;
+    }
+    uint8_t *const out = &enc->buf[enc->len];
+    enc->len += len;
+    return out;
+}
+
+static void put_be(struct codec_encoder *const enc, uint64_t const val, size_t const width) {
+    uint8_t *const out = reserve(enc, width);
+    if (out == NULL) return;
+    for (size_t i = 0; i < width; i++) {
+        out[i] = val >> (8 * (width - 1 - i));
+    }
+}
+
+static void put_bytes(struct codec_encoder *const enc, struct codec_field const *const field, size_t const len) {
+    uint8_t *const out = reserve(enc, len);
+    if (out == NULL) return;
+    enc->bytes(enc->ctx, field->kind, field->name, out, len);
+}
+
+static uint64_t field_value(struct codec_encoder *const enc, struct codec_field const *const field, uint64_t const bound) {
+    uint64_t const val = enc->value(enc->ctx, field->kind, field->name, bound);
+    return val > bound ? bound : val;
+}
+
+static void encode_schema(struct codec_encoder *const enc, struct codec_field const *const schema);
+
+static void encode_field(struct codec_encoder *const enc, struct codec_field const *const field) {
+    switch (field->kind) {
+        case CODEC_U16:
+            put_be(enc, field_value(enc, field, UINT16_MAX), sizeof(uint16_t));
+            break;
+        case CODEC_U32:
+            put_be(enc, field_value(enc, field, UINT32_MAX), sizeof(uint32_t));
+            break;
+        case CODEC_U64:
+            put_be(enc, field_value(enc, field, UINT64_MAX), sizeof(uint64_t));
+            break;
+        case CODEC_ID32:
+            put_bytes(enc, field, sizeof(Id32));
+            break;
+        case CODEC_ADDRESS:
+            put_bytes(enc, field, sizeof(Address));
+            break;
+        case CODEC_STRUCT:
+            encode_schema(enc, field->sub);
+            break;
+        case CODEC_VARIANT: {
+            struct codec_variant const *const variants = field->sub;
+            size_t n = 0;
+            while (variants[n].schema != NULL) n++;
+            size_t const i = enc->value(enc->ctx, field->kind, field->name, n) % n;
+            put_be(enc, variants[i].type_id, sizeof(uint32_t));
+            encode_schema(enc, variants[i].schema);
+            break;
+        }
+        case CODEC_SKIP: {
+            uint32_t const len = field_value(enc, field, UINT32_MAX);
+            put_be(enc, len, sizeof(uint32_t));
+            put_bytes(enc, field, len);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+static void encode_schema(struct codec_encoder *const enc, struct codec_field const *const schema) {
+    for (struct codec_field const *field = schema; field->kind != CODEC_END && !enc->overflowed; field++) {
+        if (field->kind == CODEC_ARRAY) {
+            uint32_t const n = field_value(enc, field, UINT32_MAX);
+            put_be(enc, n, sizeof(uint32_t));
+            field++;
+            for (uint32_t i = 0; i < n && !enc->overflowed; i++) {
+                encode_field(enc, field);
+            }
+        } else {
+            encode_field(enc, field);
+        }
+    }
+}
+
+#define CODEC_GEN_ENCODE_(Name) \
+    bool codec_encode_ ## Name(struct codec_encoder *const enc) { \
+        encode_schema(enc, Name ## _schema); \
+        return !enc->overflowed; \
+    }
+CODEC_SCHEMAS(CODEC_GEN_ENCODE_, CODEC_GEN_ENCODE_NONE_)
+
+// xorshift64*
+static uint64_t random_next(struct codec_random *const rng) {
+    rng->seed ^= rng->seed >> 12;
+    rng->seed ^= rng->seed << 25;
+    rng->seed ^= rng->seed >> 27;
+    return rng->seed * 0x2545F4914F6CDD1DULL;
+}
+
+static uint64_t random_value(void *const ctx, enum codec_field_kind const kind, char const *const name, uint64_t const bound) {
+    struct codec_random *const rng = ctx;
+    uint64_t const r = random_next(rng);
+    switch (kind) {
+        case CODEC_VARIANT:
+            return r % bound;
+        case CODEC_ARRAY:
+            return strcmp(name, "addresses") == 0 ? 1 : r % 4;
+        case CODEC_SKIP:
+            return r % 64;
+        case CODEC_U64:
+            if (strcmp(name, "amount") == 0 || strcmp(name, "weight") == 0) return 1 + r % 1000000000000ULL;
+            if (strstr(name, "time") != NULL) return r % UINT32_MAX;
+            return r;
+        default:
+            return r & bound;
+    }
+}
+
+static void random_bytes(void *const ctx, enum codec_field_kind const kind, char const *const name, uint8_t *const out, size_t const len) {
+    struct codec_random *const rng = ctx;
+    if (kind == CODEC_ID32 && strcmp(name, "asset_id") == 0) {
+        memcpy(out, &rng->asset_id, len);
+        return;
+    }
+    for (size_t i = 0; i < len; i++) {
+        out[i] = random_next(rng);
+    }
+}
+
+void codec_encoder_init_random(struct codec_encoder *const enc, uint8_t *const buf, size_t const size, struct codec_random *const rng) {
+    memset(enc, 0, sizeof(*enc));
+    enc->buf = buf;
+    enc->size = size;
+    enc->value = random_value;
+    enc->bytes = random_bytes;
+    enc->ctx = rng;
+    if (rng->seed == 0) rng->seed = 1;
+}
+
+#endif
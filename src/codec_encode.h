@@ -0,0 +1,38 @@
+#pragma once
+
+// Host-side encoder for the schemas in codec_schema.h, for generating test
+// corpora at native speed. Never built into the app.
+#ifdef CODEC_HOST_ENCODER
+
+#include "codec_schema.h"
+
+struct codec_encoder {
+    uint8_t *buf;
+    size_t size;
+    size_t len;
+    bool overflowed; // Set instead of writing past size
+
+    // Value for an integer field, an ARRAY count or a SKIP length, no larger
+    // than bound; for a VARIANT, the index of the alternative, below bound.
+    uint64_t (*value)(void *ctx, enum codec_field_kind kind, char const *name, uint64_t bound);
+    // Contents of an ID32 or ADDRESS field, or of the bytes a SKIP covers.
+    void (*bytes)(void *ctx, enum codec_field_kind kind, char const *name, uint8_t *out, size_t len);
+    void *ctx;
+};
+
+// Random but parseable values: asset IDs are asset_id, outputs have exactly
+// one address, and amounts and times are small enough not to overflow.
+struct codec_random {
+    uint64_t seed;
+    Id32 asset_id;
+};
+
+void codec_encoder_init_random(struct codec_encoder *const enc, uint8_t *const buf, size_t const size, struct codec_random *const rng);
+
+// bool codec_encode_<Name>(struct codec_encoder *enc) appends one <Name> and
+// returns false if it did not fit.
+#define CODEC_GEN_ENCODE_DECL_(Name) bool codec_encode_ ## Name(struct codec_encoder *const enc);
+#define CODEC_GEN_ENCODE_NONE_(Name)
+CODEC_SCHEMAS(CODEC_GEN_ENCODE_DECL_, CODEC_GEN_ENCODE_NONE_)
+
+#endif
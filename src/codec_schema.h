@@ -0,0 +1,155 @@
+#pragma once
+
+#include "codec.h"
+
+// Wire format of the Avalanche structures, written once as X-macros.
+//
+// CODEC_SCHEMA_<Name>(FIELD, NESTED) lists the fields of <Name> in wire order:
+//   FIELD(kind, name, hook)
+//   NESTED(kind, name, sub, hook)  -- STRUCT of schema sub, or VARIANT of variants sub
+// CODEC_VARIANTS_<Name>(VARIANT) lists VARIANT(type_id, schema) alternatives.
+//
+// CODEC_DEFINE_SCHEMAS() expands to the static codec_field tables for all of them.
+
+#define CODEC_SCHEMA_SECP256K1TransferOutput(FIELD, NESTED) \
+    FIELD(U64, amount, output_amount_hook) \
+    FIELD(U64, locktime, NULL) \
+    FIELD(U32, threshold, NULL) \
+    FIELD(ARRAY, addresses, single_address_hook) \
+    FIELD(ADDRESS, address, transfer_output_address_hook)
+
+#define CODEC_VARIANTS_LockedOutput(VARIANT) \
+    VARIANT(0x00000007, SECP256K1TransferOutput)
+
+#define CODEC_SCHEMA_StakeableLockOutput(FIELD, NESTED) \
+    FIELD(U64, locktime, locktime_hook) \
+    NESTED(VARIANT, output, LockedOutput, locked_funds_hook)
+
+#define CODEC_VARIANTS_Output(VARIANT) \
+    VARIANT(0x00000007, SECP256K1TransferOutput) \
+    VARIANT(0x00000016, StakeableLockOutput)
+
+#define CODEC_SCHEMA_TransferableOutput(FIELD, NESTED) \
+    FIELD(ID32, asset_id, check_asset_id_hook) \
+    NESTED(VARIANT, output, Output, NULL)
+
+#define CODEC_SCHEMA_TransferableOutputs(FIELD, NESTED) \
+    FIELD(ARRAY, outputs, NULL) \
+    NESTED(STRUCT, output, TransferableOutput, NULL)
+
+#define CODEC_SCHEMA_SECP256K1TransferInput(FIELD, NESTED) \
+    FIELD(U64, amount, input_amount_hook) \
+    FIELD(ARRAY, address_indices, NULL) \
+    FIELD(U32, address_index, NULL)
+
+#define CODEC_VARIANTS_LockedInput(VARIANT) \
+    VARIANT(0x00000005, SECP256K1TransferInput)
+
+#define CODEC_SCHEMA_StakeableLockInput(FIELD, NESTED) \
+    FIELD(U64, locktime, NULL) \
+    NESTED(VARIANT, input, LockedInput, NULL)
+
+#define CODEC_VARIANTS_Input(VARIANT) \
+    VARIANT(0x00000005, SECP256K1TransferInput) \
+    VARIANT(0x00000015, StakeableLockInput)
+
+#define CODEC_SCHEMA_TransferableInput(FIELD, NESTED) \
+    FIELD(ID32, tx_id, NULL) \
+    FIELD(U32, utxo_index, NULL) \
+    FIELD(ID32, asset_id, check_asset_id_hook) \
+    NESTED(VARIANT, input, Input, NULL)
+
+#define CODEC_SCHEMA_TransferableInputs(FIELD, NESTED) \
+    FIELD(ARRAY, inputs, NULL) \
+    NESTED(STRUCT, input, TransferableInput, NULL)
+
+#define CODEC_SCHEMA_Memo(FIELD, NESTED) \
+    FIELD(SKIP, memo, NULL)
+
+#define CODEC_SCHEMA_SECP256K1OutputOwners(FIELD, NESTED) \
+    FIELD(U32, type_id, NULL) \
+    FIELD(U64, locktime, NULL) \
+    FIELD(U32, threshold, owners_threshold_hook) \
+    FIELD(ARRAY, addresses, single_address_hook) \
+    FIELD(ADDRESS, address, owners_address_hook)
+
+#define CODEC_SCHEMA_SubnetAuth(FIELD, NESTED) \
+    FIELD(U32, type_id, NULL) \
+    FIELD(ARRAY, sig_indices, NULL) \
+    FIELD(U32, sig_index, NULL)
+
+#define CODEC_SCHEMA_Validator(FIELD, NESTED) \
+    FIELD(ADDRESS, node_id, validator_node_hook) \
+    FIELD(U64, start_time, validator_start_hook) \
+    FIELD(U64, end_time, validator_end_hook) \
+    FIELD(U64, weight, validator_weight_hook)
+
+#define CODEC_SCHEMA_EVMOutput(FIELD, NESTED) \
+    FIELD(ADDRESS, address, evm_output_address_hook) \
+    FIELD(U64, amount, output_amount_hook) \
+    FIELD(ID32, asset_id, evm_output_asset_hook)
+
+#define CODEC_SCHEMA_EVMOutputs(FIELD, NESTED) \
+    FIELD(ARRAY, outputs, NULL) \
+    NESTED(STRUCT, output, EVMOutput, NULL)
+
+#define CODEC_SCHEMA_EVMInput(FIELD, NESTED) \
+    FIELD(ADDRESS, address, NULL) \
+    FIELD(U64, amount, input_amount_hook) \
+    FIELD(ID32, asset_id, NULL) \
+    FIELD(U64, nonce, NULL)
+
+#define CODEC_SCHEMA_EVMInputs(FIELD, NESTED) \
+    FIELD(ARRAY, inputs, NULL) \
+    NESTED(STRUCT, input, EVMInput, NULL)
+
+// Every schema and variant set, each after everything it refers to.
+#define CODEC_SCHEMAS(SCHEMA, VARIANTS) \
+    SCHEMA(SECP256K1TransferOutput) \
+    VARIANTS(LockedOutput) \
+    SCHEMA(StakeableLockOutput) \
+    VARIANTS(Output) \
+    SCHEMA(TransferableOutput) \
+    SCHEMA(TransferableOutputs) \
+    SCHEMA(SECP256K1TransferInput) \
+    VARIANTS(LockedInput) \
+    SCHEMA(StakeableLockInput) \
+    VARIANTS(Input) \
+    SCHEMA(TransferableInput) \
+    SCHEMA(TransferableInputs) \
+    SCHEMA(Memo) \
+    SCHEMA(SECP256K1OutputOwners) \
+    SCHEMA(SubnetAuth) \
+    SCHEMA(Validator) \
+    SCHEMA(EVMOutput) \
+    SCHEMA(EVMOutputs) \
+    SCHEMA(EVMInput) \
+    SCHEMA(EVMInputs)
+
+////
+
+#define CODEC_SUB_STRUCT(sub) sub ## _schema
+#define CODEC_SUB_VARIANT(sub) sub ## _variants
+
+#define CODEC_GEN_FIELD_(kind, name, hook) \
+    CODEC_FIELD(CODEC_ ## kind, name, CODEC_HOOK(hook)),
+#define CODEC_GEN_NESTED_(kind, name, sub, hook) \
+    CODEC_NESTED(CODEC_ ## kind, name, CODEC_SUB_ ## kind(sub), CODEC_HOOK(hook)),
+#define CODEC_GEN_VARIANT_(type_id, schema) \
+    { type_id, schema ## _schema },
+
+#define CODEC_GEN_SCHEMA_(Name) \
+    static struct codec_field const Name ## _schema[] = { \
+        CODEC_SCHEMA_ ## Name(CODEC_GEN_FIELD_, CODEC_GEN_NESTED_) \
+        CODEC_FIELDS_END \
+    };
+#define CODEC_GEN_VARIANTS_(Name) \
+    static struct codec_variant const Name ## _variants[] = { \
+        CODEC_VARIANTS_ ## Name(CODEC_GEN_VARIANT_) \
+        { 0, NULL } \
+    };
+
+// Expands to every schema table. The including file defines CODEC_HOOK(hook)
+// to either the hook itself or NULL.
+#define CODEC_DEFINE_SCHEMAS() \
+    CODEC_SCHEMAS(CODEC_GEN_SCHEMA_, CODEC_GEN_VARIANTS_)
@@ -0,0 +1,94 @@
+#include "erc20_cache.h"
+
+#include "globals.h"
+#include "protocol.h"
+
+#include <string.h>
+
+#define C global.erc20_cache
+
+#define ERC20_MAX_DECIMALS 77 // Digits in the largest uint256
+
+// The key Ledger signs its crypto asset list with, as app-ethereum checks it.
+// Test builds use a key whose private half is in tests/eth-tests.ts instead.
+static uint8_t const cal_public_key[] = {
+#ifdef HAVE_CAL_TEST_KEY
+    0x04, 0x70, 0x51, 0x10, 0xde, 0x3d, 0x34, 0x47, 0x94, 0x62, 0x64, 0x0e, 0x80,
+    0xcc, 0xd4, 0xbd, 0x2b, 0xe1, 0xc1, 0xab, 0x75, 0xc4, 0xcd, 0x80, 0x35, 0x48,
+    0xf0, 0xe3, 0x50, 0xa4, 0xf5, 0xa0, 0x44, 0xa8, 0xe9, 0x05, 0x1f, 0x5d, 0x85,
+    0x10, 0x69, 0x17, 0x63, 0xe7, 0xa5, 0x5d, 0xca, 0xac, 0x22, 0x7e, 0x77, 0x41,
+    0x30, 0x05, 0x13, 0x22, 0xe1, 0x03, 0x29, 0xd1, 0x15, 0x66, 0x9a, 0xed, 0x73,
+#else
+    0x04, 0x5e, 0x6c, 0x10, 0x20, 0xc1, 0x4d, 0xc4, 0x64, 0x42, 0xfe, 0x89, 0xf9,
+    0x7c, 0x0b, 0x68, 0xcd, 0xb1, 0x59, 0x76, 0xdc, 0x24, 0xf2, 0x4c, 0x31, 0x6e,
+    0x7b, 0x30, 0xfe, 0x4e, 0x8c, 0xc7, 0x6b, 0x14, 0x89, 0x15, 0x0c, 0x21, 0x51,
+    0x4e, 0xbf, 0x44, 0x0f, 0xf5, 0xde, 0xa5, 0x39, 0x3d, 0x83, 0xde, 0x53, 0x58,
+    0xcd, 0x09, 0x8f, 0xce, 0x8f, 0xd0, 0xf8, 0x1d, 0xaa, 0x94, 0x97, 0x91, 0x83,
+#endif
+};
+
+// The ticker and decimals end up on the trusted display, so they must come
+// from the crypto asset list and not from the host.
+static void check_descriptor_signature(uint8_t const *const signed_data, size_t const signed_size,
+                                       uint8_t const *const signature, size_t const signature_size) {
+    uint8_t hash[CX_SHA256_SIZE];
+    cx_hash_sha256(signed_data, signed_size, hash, sizeof(hash));
+
+    cx_ecfp_public_key_t key;
+    cx_ecfp_init_public_key(CX_CURVE_SECP256K1, cal_public_key, sizeof(cal_public_key), &key);
+    if (!cx_ecdsa_verify(&key, CX_LAST, CX_SHA256, hash, sizeof(hash), signature, signature_size))
+        THROW_(EXC_SECURITY, "ERC-20 descriptor not signed by the crypto asset list");
+}
+
+void erc20_cache_provide(uint8_t const *const in, size_t const in_size) {
+    check_null(in);
+
+    size_t ix = 0;
+    if (ix + sizeof(uint8_t) > in_size) THROW_(EXC_WRONG_LENGTH, "Input too small");
+    uint8_t const ticker_length = CONSUME_UNALIGNED_BIG_ENDIAN(ix, uint8_t, &in[ix]);
+    if (ticker_length == 0 || ticker_length > ERC20_TICKER_MAX_LENGTH) THROW_(EXC_WRONG_VALUES, "Bad ticker length");
+
+    if (ix + ticker_length + ERC20_CONTRACT_ADDRESS_SIZE + 2 * sizeof(uint32_t) > in_size)
+        THROW_(EXC_WRONG_LENGTH, "Input too small");
+    uint8_t const *const ticker = &in[ix];
+    ix += ticker_length;
+    for (size_t i = 0; i < ticker_length; i++) {
+        if (ticker[i] < 0x21 || ticker[i] > 0x7e) THROW_(EXC_WRONG_VALUES, "Ticker is not printable ASCII");
+    }
+
+    uint8_t const *const address = &in[ix];
+    ix += ERC20_CONTRACT_ADDRESS_SIZE;
+
+    uint32_t const decimals = CONSUME_UNALIGNED_BIG_ENDIAN(ix, uint32_t, &in[ix]);
+    if (decimals > ERC20_MAX_DECIMALS) THROW_(EXC_WRONG_VALUES, "Too many decimals");
+    uint32_t const chain_id = CONSUME_UNALIGNED_BIG_ENDIAN(ix, uint32_t, &in[ix]);
+
+    if (ix == in_size) THROW_(EXC_WRONG_LENGTH, "Missing descriptor signature");
+    check_descriptor_signature(ticker, ix - sizeof(uint8_t), &in[ix], in_size - ix);
+
+    erc20_cache_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(entry.token.address, address, sizeof(entry.token.address));
+    entry.token.decimals = (uint8_t)decimals;
+    memcpy(entry.token.ticker, ticker, ticker_length);
+    entry.chain_id = chain_id;
+    PRINTF("Providing ERC-20 token %s at %.*h on chain %u\n", entry.token.ticker, sizeof(entry.token.address), entry.token.address, entry.chain_id);
+
+    // A contract provided again replaces its earlier entry.
+    erc20_cache_entry_t *slot = (erc20_cache_entry_t *)erc20_cache_find(entry.token.address);
+    if (slot == NULL) {
+        slot = &C.entries[C.next_slot % ERC20_CACHE_SIZE];
+        C.next_slot = (C.next_slot + 1) % ERC20_CACHE_SIZE;
+    }
+    memcpy(slot, &entry, sizeof(entry));
+}
+
+erc20_cache_entry_t const *erc20_cache_find(uint8_t const *const address) {
+    check_null(address);
+    for (size_t i = 0; i < ERC20_CACHE_SIZE; i++) {
+        if (C.entries[i].token.ticker[0] != '\0' && !memcmp(C.entries[i].token.address, address, ERC20_CONTRACT_ADDRESS_SIZE)) {
+            return &C.entries[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bolos_target.h"
+#include "types.h"
+
+// Token metadata the host provides ahead of signing (EVM INS 0x0a), so that
+// ERC-20 amounts can be shown in token units instead of raw integers.
+
+#define ERC20_CONTRACT_ADDRESS_SIZE 20
+#define ERC20_TICKER_MAX_LENGTH 10
+
+typedef struct {
+    uint8_t address[ERC20_CONTRACT_ADDRESS_SIZE];
+    uint8_t decimals;
+    char ticker[ERC20_TICKER_MAX_LENGTH + 1]; // Empty marks an unused slot
+} erc20_token_t;
+
+// The chain is only needed to check the transaction against, so prompts copy
+// just the token.
+typedef struct {
+    erc20_token_t token;
+    uint32_t chain_id; // The chain the descriptor was signed for
+} erc20_cache_entry_t;
+
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define ERC20_CACHE_SIZE 8
+#else
+#define ERC20_CACHE_SIZE 1
+#endif
+
+// Kept outside global.apdu, since the host sends the tokens as separate
+// instructions before the transaction. Replacement is round-robin.
+typedef struct {
+    erc20_cache_entry_t entries[ERC20_CACHE_SIZE];
+    uint8_t next_slot;
+} erc20_cache_t;
+
+// Adds a token from a descriptor in the format hw-app-eth's
+// provideERC20TokenInformation sends: ticker length (1 byte), ticker,
+// contract address (20 bytes), decimals (4 bytes BE), chain ID (4 bytes BE),
+// then a DER signature of the SHA-256 of everything between the ticker length
+// and the signature. Descriptors not signed by Ledger's crypto asset list key
+// (a test key in CAL_TEST_KEY=1 builds) are rejected.
+void erc20_cache_provide(uint8_t const *const in, size_t const in_size);
+
+// Returns the entry for a contract address, or NULL if none was provided.
+erc20_cache_entry_t const *erc20_cache_find(uint8_t const *const address);
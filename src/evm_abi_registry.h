@@ -0,0 +1,75 @@
+// Generated by abi/gen_registry.py from abi/erc20.json, abi/multicall.json, abi/router.json, abi/wavax.json. DO NOT EDIT.
+// Regenerate with `make abi-registry`.
+#pragma once
+
+#define ABI_MAX_PARAMETERS 5
+
+// X(name, type)
+#define ABI_REGISTRY_PARAMETERS(X) \
+  X("spender", ABI_TYPE_ADDRESS) \
+  X("amount", ABI_TYPE_AMOUNT) \
+  X("sender", ABI_TYPE_ADDRESS) \
+  X("recipient", ABI_TYPE_ADDRESS) \
+  X("wad", ABI_TYPE_AMOUNT) \
+  X("role", ABI_TYPE_BYTES32) \
+  X("account", ABI_TYPE_ADDRESS) \
+  X("amountIn", ABI_TYPE_AMOUNT) \
+  X("amountOutMin", ABI_TYPE_AMOUNT) \
+  X("path", ABI_ARRAY_OF(ABI_TYPE_ADDRESS)) \
+  X("to", ABI_TYPE_ADDRESS) \
+  X("deadline", ABI_TYPE_INTEGER) \
+  X("addedValue", ABI_TYPE_AMOUNT) \
+  X("data", ABI_ARRAY_OF(ABI_TYPE_BYTES)) \
+  X("amountOut", ABI_TYPE_AMOUNT) \
+  X("amountInMax", ABI_TYPE_AMOUNT) \
+  X("subtractedValue", ABI_TYPE_AMOUNT) \
+
+// X(selector, name, payable, parameter count, parameter indices...), sorted by selector
+#define ABI_REGISTRY_METHODS(X) \
+  /* approve(address,uint256) */ \
+  X("\x09\x5e\xa7\xb3", "approve", false, 2, 0, 1) \
+  /* transferFrom(address,address,uint256) */ \
+  X("\x23\xb8\x72\xdd", "transferFrom", false, 3, 2, 3, 1) \
+  /* withdraw(uint256) */ \
+  X("\x2e\x1a\x7d\x4d", "withdraw", false, 1, 4) \
+  /* grantRole(bytes32,address) */ \
+  X("\x2f\x2f\xf1\x5d", "grantRole", false, 2, 5, 6) \
+  /* renounceRole(bytes32,address) */ \
+  X("\x36\x56\x8a\xbe", "renounceRole", false, 2, 5, 6) \
+  /* swapExactTokensForTokens(uint256,uint256,address[],address,uint256) */ \
+  X("\x38\xed\x17\x39", "swapExactTokensForTokens", false, 5, 7, 8, 9, 10, 11) \
+  /* increaseAllowance(address,uint256) */ \
+  X("\x39\x50\x93\x51", "increaseAllowance", false, 2, 0, 12) \
+  /* unpause() */ \
+  X("\x3f\x4b\xa8\x3a", "unpause", false, 0) \
+  /* mint(address,uint256) */ \
+  X("\x40\xc1\x0f\x19", "mint", false, 2, 10, 1) \
+  /* burn(uint256) */ \
+  X("\x42\x96\x6c\x68", "burn", false, 1, 1) \
+  /* multicall(uint256,bytes[]) */ \
+  X("\x5a\xe4\x01\xdc", "multicall", true, 2, 11, 13) \
+  /* swapExactTokensForAVAX(uint256,uint256,address[],address,uint256) */ \
+  X("\x67\x65\x28\xd1", "swapExactTokensForAVAX", false, 5, 7, 8, 9, 10, 11) \
+  /* burnFrom(address,uint256) */ \
+  X("\x79\xcc\x67\x90", "burnFrom", false, 2, 6, 1) \
+  /* swapTokensForExactAVAX(uint256,uint256,address[],address,uint256) */ \
+  X("\x7a\x42\x41\x6a", "swapTokensForExactAVAX", false, 5, 14, 15, 9, 10, 11) \
+  /* pause() */ \
+  X("\x84\x56\xcb\x59", "pause", false, 0) \
+  /* swapTokensForExactTokens(uint256,uint256,address[],address,uint256) */ \
+  X("\x88\x03\xdb\xee", "swapTokensForExactTokens", false, 5, 14, 15, 9, 10, 11) \
+  /* swapAVAXForExactTokens(uint256,address[],address,uint256) */ \
+  X("\x8a\x65\x7e\x67", "swapAVAXForExactTokens", true, 4, 14, 9, 10, 11) \
+  /* swapExactAVAXForTokens(uint256,address[],address,uint256) */ \
+  X("\xa2\xa1\x62\x3d", "swapExactAVAXForTokens", true, 4, 8, 9, 10, 11) \
+  /* decreaseAllowance(address,uint256) */ \
+  X("\xa4\x57\xc2\xd7", "decreaseAllowance", false, 2, 0, 16) \
+  /* transfer(address,uint256) */ \
+  X("\xa9\x05\x9c\xbb", "transfer", false, 2, 3, 1) \
+  /* multicall(bytes[]) */ \
+  X("\xac\x96\x50\xd8", "multicall", true, 1, 13) \
+  /* deposit() */ \
+  X("\xd0\xe3\x0d\xb0", "deposit", true, 0) \
+  /* revokeRole(bytes32,address) */ \
+  X("\xd5\x47\x74\x1f", "revokeRole", false, 2, 5, 6) \
+
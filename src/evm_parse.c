@@ -2,9 +2,11 @@
 #include "exception.h"
 #include "globals.h"
 #include "evm_parse.h"
+#include "hash.h"
 #include "parser-impl.h"
 #include "protocol.h"
 #include "to_string.h"
+#include "trace.h"
 #include "types.h"
 #include "evm_abi.h"
 
@@ -12,8 +14,9 @@
 #define ETHEREUM_SELECTOR_SIZE 4
 #define ETHEREUM_WORD_SIZE 32
 
-void init_rlp_list(struct EVM_RLP_txn_state *const state) {
-    memset(state, 0, sizeof(*state)); // sizeof == 224UL
+void init_rlp_list(struct EVM_RLP_txn_state *const state, enum txn_being_parsed_t const type) {
+    memset(state, 0, sizeof(*state));
+    state->type = type;
 }
 
 void init_rlp_item(struct EVM_RLP_item_state *const state) {
@@ -86,6 +89,51 @@ static void output_evm_calldata_preview_to_string(
   out[ix] = '\0';
 }
 
+static void output_evm_abi_value_to_string(
+  char out[const], size_t const out_size,
+  output_prompt_t const *const in)
+{
+  static char const empty[] = "Empty";
+  size_t ix = 0;
+  bool is_text = in->abi_value.is_string;
+  for (size_t i = 0; i < in->abi_value.count; i++) {
+    if (in->abi_value.preview[i] < 0x20 || in->abi_value.preview[i] > 0x7e) is_text = false;
+  }
+
+  if (in->abi_value.length == 0) {
+    if (sizeof(empty) > out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+    memcpy(out, empty, sizeof(empty));
+    return;
+  } else if (is_text) {
+    if (in->abi_value.count >= out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+    memcpy(out, in->abi_value.preview, in->abi_value.count);
+    ix = in->abi_value.count;
+  } else {
+    ix = output_hex_to_string(out, out_size, &in->abi_value.preview[0], in->abi_value.count);
+  }
+
+  if (in->abi_value.count < in->abi_value.length) {
+    static char const cropped[] = "... (";
+    static char const bytes[] = " bytes";
+    static char const hash[] = ", Keccak ";
+    if (ix + sizeof(cropped) + MAX_INT_DIGITS + sizeof(bytes) + sizeof(hash) + 2 + 2 * sizeof(in->abi_value.hash) + 1 > out_size)
+      THROW_(EXC_MEMORY_ERROR, "Can't fit into prompt value string");
+    memcpy(&out[ix], cropped, sizeof(cropped) - 1);
+    ix += sizeof(cropped) - 1;
+    ix += number_to_string(&out[ix], in->abi_value.length);
+    memcpy(&out[ix], bytes, sizeof(bytes) - 1);
+    ix += sizeof(bytes) - 1;
+    if (in->abi_value.hashed) {
+      memcpy(&out[ix], hash, sizeof(hash) - 1);
+      ix += sizeof(hash) - 1;
+      ix += output_hex_to_string(&out[ix], out_size - ix, &in->abi_value.hash[0], sizeof(in->abi_value.hash));
+    }
+    out[ix] = ')';
+    ix++;
+  }
+  out[ix] = '\0';
+}
+
 static void output_evm_gas_limit_to_string(
   char out[const], size_t const out_size,
   output_prompt_t const *const in)
@@ -101,11 +149,57 @@ static void output_evm_amount_to_string(
   wei_to_gwei_string_256(out, out_size, &in->amount_big);
 }
 
+static void output_evm_integer_to_string(
+  char out[const], size_t const out_size,
+  output_prompt_t const *const in)
+{
+  if (tostring256(&in->amount_big, 10, out, out_size) == (size_t)-1)
+    THROW_(EXC_MEMORY_ERROR, "Can't fit integer into prompt value string");
+}
+
+static void output_erc20_amount_to_string(
+  char out[const], size_t const out_size,
+  output_prompt_t const *const in)
+{
+  size_t ix = subunit_to_unit_string_256(out, out_size, &in->erc20_amount.amount, in->erc20_amount.token.decimals);
+  size_t const ticker_length = strnlen(in->erc20_amount.token.ticker, ERC20_TICKER_MAX_LENGTH);
+  if (ix + 1 + ticker_length + 1 > out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit the ticker into prompt value string");
+  out[ix] = ' '; ix++;
+  memcpy(&out[ix], in->erc20_amount.token.ticker, ticker_length);
+  ix += ticker_length;
+  out[ix] = '\0';
+}
+
 static void output_evm_fee_to_string(
   char out[const], size_t const out_size,
   output_prompt_t const *const in)
 {
-  wei_to_gwei_string(out, out_size, in->fee);
+  wei_to_gwei_string_256(out, out_size, &in->amount_big);
+}
+
+static size_t output_count_to_string(
+  char out[const], size_t const out_size,
+  uint32_t const count, char const *const singular, char const *const plural)
+{
+  char const *const noun = count == 1 ? singular : plural;
+  size_t const noun_length = strlen(noun);
+  if (MAX_INT_DIGITS + 1 + noun_length + 1 > out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit count into prompt value string");
+  size_t ix = number_to_string(out, count);
+  out[ix] = ' '; ix++;
+  memcpy(&out[ix], noun, noun_length + 1);
+  return ix + noun_length;
+}
+
+static void output_evm_access_list_to_string(
+  char out[const], size_t const out_size,
+  output_prompt_t const *const in)
+{
+  size_t ix = output_count_to_string(out, out_size, in->access_list.addresses, "address", "addresses");
+  static char const separator[] = ", ";
+  if (ix + sizeof(separator) > out_size) THROW_(EXC_MEMORY_ERROR, "Can't fit ', ' into prompt value string");
+  memcpy(&out[ix], separator, sizeof(separator));
+  ix += sizeof(separator) - 1;
+  output_count_to_string(&out[ix], out_size - ix, in->access_list.storage_keys, "storage key", "storage keys");
 }
 
 static void output_evm_fund_to_string(
@@ -180,33 +274,7 @@ static void output_assetCall_prompt_to_string(
   output_evm_address_to_string(&out[ix], out_size - ix, in);
 }
 
-enum parse_rv parse_rlp_item(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
-enum parse_rv parse_rlp_item_to_buffer(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
-enum parse_rv parse_rlp_item_data(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
-
-enum eth_legacy_txn_items {
-  EVM_LEGACY_TXN_NONCE,
-  EVM_LEGACY_TXN_GASPRICE,
-  EVM_LEGACY_TXN_STARTGAS,
-  EVM_LEGACY_TXN_TO,
-  EVM_LEGACY_TXN_VALUE,
-  EVM_LEGACY_TXN_DATA,
-  EVM_LEGACY_TXN_CHAINID,
-  EVM_LEGACY_TXN_SIG_R,
-  EVM_LEGACY_TXN_SIG_S
-};
-
-enum eth_eip1559_txn_items {
-  EVM_EIP1559_TXN_CHAINID,
-  EVM_EIP1559_TXN_NONCE,
-  EVM_EIP1559_TXN_MAX_PRIORITY_FEE_PER_GAS,
-  EVM_EIP1559_TXN_MAX_FEE_PER_GAS,
-  EVM_EIP1559_TXN_GAS_LIMIT,
-  EVM_EIP1559_TXN_TO,
-  EVM_EIP1559_TXN_VALUE,
-  EVM_EIP1559_TXN_DATA,
-  EVM_EIP1559_TXN_ACCESS_LIST
-};
+enum parse_rv impl_parse_rlp_item(struct EVM_RLP_item_state *const state, evm_parser_meta_state_t *const meta, size_t max_bytes_to_buffer);
 
 void init_assetCall_data(struct EVM_assetCall_state *const state, uint64_t length);
 enum parse_rv parse_assetCall_data(struct EVM_assetCall_state *const state, parser_input_meta_state_t *const input, evm_parser_meta_state_t *const meta);
@@ -247,11 +315,15 @@ uint256_t enforceParsedScalarFits256Bits(struct EVM_RLP_item_state *const state)
 
 
 const uint8_t EIP1559_TYPE_VALUE = 0x02;
+const uint8_t EIP2930_TYPE_VALUE = 0x01;
 
 void checkDataFieldLengthFitsTransaction(struct EVM_RLP_txn_state *const state) {
   // If data field can't possibly fit in the transaction, the rlp is malformed
-  if(state->rlpItem_state.len_len > state->remaining)
-    REJECT("Malformed data length. Expected length of length %u", state->rlpItem_state.len_len);
+  struct EVM_RLP_item_state const *const item_state = &state->rlpItem_state;
+  if(item_state->state == 1 && item_state->len_len > state->remaining)
+    REJECT("Malformed data length. Expected length of length %u", item_state->len_len);
+  if(item_state->state >= 2 && item_state->length - item_state->current > state->remaining)
+    REJECT("Malformed data length. Data does not fit in the transaction");
 }
 
 enum parse_rv parse_evm_txn(struct EVM_txn_state *const state, evm_parser_meta_state_t *const meta) {
@@ -259,36 +331,27 @@ enum parse_rv parse_evm_txn(struct EVM_txn_state *const state, evm_parser_meta_s
     switch (state->state) {
       case 0: {
         sub_rv = parse_core_uint8_t(&state->transaction_envelope_type, &meta->input);
-        RET_IF_NOT_DONE;
+        BREAK_IF_NOT_DONE;
         if (state->transaction_envelope_type.val == EIP1559_TYPE_VALUE) {
           state->type = EIP1559;
-          init_rlp_list(&state->txn_state); // could technically be a different init in each case, so we repeat ourselves
+        } else if (state->transaction_envelope_type.val == EIP2930_TYPE_VALUE) {
+          state->type = EIP2930;
         } else {
           state->type = LEGACY;
-          init_rlp_list(&state->txn_state); // could technically be a different init in each case, so we repeat ourselves
           // we consumed a byte that the Legacy parser was expecting, so decrement before legacy parser begins
           if (meta->input.consumed < 1) {
             REJECT("a byte was consumed but this was not reflected in the \"input consumed bytes\" counter") // should be impossible
           }
           meta->input.consumed--;
         }
+        init_rlp_list(&state->txn_state, state->type);
         state->state++;
       } fallthrough;
       case 1: {
-        switch (state->type) {
-          case EIP1559: {
-            sub_rv = parse_eip1559_rlp_txn(&state->txn_state, meta);
-            RET_IF_NOT_DONE;
-            break;
-          }
-          case LEGACY: {
-            sub_rv = parse_legacy_rlp_txn(&state->txn_state, meta);
-            RET_IF_NOT_DONE;
-            break;
-          }
-        } // end switch state->type
+        sub_rv = parse_rlp_txn(&state->txn_state, meta);
       }
     } // end switch state->state
+    PARSE_STATS_RV(meta->stats, sub_rv);
     return sub_rv;
 }
 
@@ -297,33 +360,9 @@ void init_evm_txn(struct EVM_txn_state *const state) {
   init_uint8_t(&state->transaction_envelope_type);
 }
 
-#define PARSE_ITEM(ITEM, save) \
-  /* NOTE! */                  \
-  fallthrough;                 \
-  PARSE_ITEM_FIRST(ITEM, save)
-
-// No fallthrough, so we don't get warning
-#define PARSE_ITEM_FIRST(ITEM, save)                         \
-  case ITEM:                                                 \
-  JUST_PARSE_ITEM(ITEM, save)
-
-#define JUST_PARSE_ITEM(ITEM, save)                          \
-  {                                                          \
-    itemStartIdx = meta->input.consumed;                     \
-    PRINTF("Entering " #ITEM "\n");                          \
-    sub_rv = parse_rlp_item ## save(state, meta);            \
-    PRINTF("Exiting " #ITEM "\n");                           \
-    size_t to_sub = meta->input.consumed - itemStartIdx;     \
-    if (to_sub > state->remaining) {                         \
-      REJECT(                                                \
-        "consumed too much parsing item: remaining: %d, this item: %d", \
-        state->remaining, to_sub); \
-    } \
-    state->remaining -= to_sub;                              \
-  } (void)0
-
 #define ITEM_ADVANCE                                         \
   PRINTF("Getting ready to advance to next item\n");         \
+  TRACE(TRACE_RLP_ITEM, state->item_index, meta->input.consumed); \
   state->item_index++;                                       \
   state->per_item_prompt = 0
 
@@ -331,6 +370,23 @@ void init_evm_txn(struct EVM_txn_state *const state) {
   ITEM_ADVANCE;                                              \
   init_rlp_item(&state->rlpItem_state);
 
+// The fee fields are summed per gas, then multiplied by the gas limit once it's
+// parsed. Only a fee that doesn't fit in 256 bits, which no account could pay,
+// is rejected.
+static void add_fee_per_gas(struct EVM_RLP_txn_state *const state) {
+  uint256_t const feePerGas = enforceParsedScalarFits256Bits(&state->rlpItem_state);
+  uint256_t sum;
+  add256(&state->fee, &feePerGas, &sum);
+  if(gt256(&feePerGas, &sum)) REJECT("Fee calculation overflowed");
+  state->fee = sum;
+}
+
+static void apply_gas_limit(struct EVM_RLP_txn_state *const state) {
+  state->gasLimit = enforceParsedScalarFits64Bits(&state->rlpItem_state);
+  uint256_t const gasLimit = {{ {{ 0, 0 }}, {{ 0, state->gasLimit }} }};
+  if(mul256_overflow(&state->fee, &gasLimit, &state->fee)) REJECT("Fee calculation overflowed");
+}
+
 void parse_value_from_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
   state->value = enforceParsedScalarFits256Bits(&state->rlpItem_state);
   SET_PROMPT_VALUE(entry->data.output_prompt.amount_big = state->value);
@@ -350,345 +406,484 @@ void prompt_calldata_preview(struct EVM_RLP_txn_state *const state, evm_parser_m
                           entry->data.output_prompt.calldata_preview.count));
 }
 
-enum parse_rv parse_legacy_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch(state->state) {
-      case 0: {
-          // cautionary, shouldn't reach greater than
-          if(meta->input.consumed >= meta->input.length) return PARSE_RV_NEED_MORE;
-          uint8_t first = meta->input.src[meta->input.consumed++];
-          if(first < 0xc0) REJECT("Transaction not an RLP list");
-          if(first < 0xf8) {
-              state->remaining = first - 0xc0;
-              state->state=2;
-          } else {
-              state->len_len = first - 0xf7;
-              state->state=1;
-          }
-        }
-        fallthrough; // NOTE
-      case 1:
-        if(state->state==1) {
-            // Max length we could get for this value is 8 bytes so uint64_state is appropriate.
-            sub_rv = parseFixed(fs(&state->uint64_state), &meta->input, state->len_len);
-            RET_IF_NOT_DONE;
-            for(size_t i = 0; i < state->len_len; i++) {
-                ((uint8_t*)(&state->remaining))[i] = state->uint64_state.buf[state->len_len-i-1];
-            }
-        }
-        init_rlp_item(&state->rlpItem_state);
-        state->state = 2;
-        fallthrough; // NOTE
-      case 2: { // Now parse items.
-          uint8_t itemStartIdx;
-          size_t gasPriceLength = 0;
-          switch(state->item_index) {
+// Charges n bytes of the access list to every list they are nested in.
+static void access_list_consume(struct EVM_access_list_state *const state, uint64_t const n) {
+  if(n > state->list_remaining) REJECT("Access list entry overruns the access list");
+  state->list_remaining -= n;
+  if(state->state >= ACCESS_LIST_ADDRESS) {
+    if(n > state->entry_remaining) REJECT("Access list item overruns its entry");
+    state->entry_remaining -= n;
+  }
+  if(state->state >= ACCESS_LIST_KEY) {
+    if(n > state->keys_remaining) REJECT("Storage key overruns the storage keys list");
+    state->keys_remaining -= n;
+  }
+}
 
-            //
-            PARSE_ITEM_FIRST(EVM_LEGACY_TXN_NONCE, );
-            RET_IF_NOT_DONE;
-            //
-
-            FINISH_ITEM_CHUNK();
-
-            //TODO: now that there's 256 bit support,
-            // rather than enforcing the length requirement,
-            // the below code block could instead load the values into
-            // 256 bit values before multiplication.
-            // Getting rid of the intermediate lengths would also allow
-            // sharing the code between PARSE_ITEM and FINISH_ITEM_CHUNK
-            // between legacy and non-legacy transaction parsers.
-            PARSE_ITEM(EVM_LEGACY_TXN_GASPRICE, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
+// Called once the length of an entry or storage keys list is known.
+static void access_list_open(struct EVM_access_list_state *const state) {
+  if(state->state <= ACCESS_LIST_ENTRY_LENGTH) {
+    if(state->entry_remaining > state->list_remaining) REJECT("Access list entry overruns the access list");
+    state->state = ACCESS_LIST_ADDRESS;
+  } else {
+    if(state->keys_remaining != state->entry_remaining) REJECT("Storage keys must end their access list entry");
+    state->state = ACCESS_LIST_KEY;
+  }
+}
 
-            uint64_t gasPrice = enforceParsedScalarFits64Bits(&state->rlpItem_state);
-            gasPriceLength = state->rlpItem_state.length;
-            state->priorityFeePerGas = gasPrice;
-            FINISH_ITEM_CHUNK();
+static void parse_access_list_chunk(struct EVM_access_list_state *const state, parser_input_meta_state_t *const chunk) {
+  while(true) {
+    if(state->state == ACCESS_LIST_KEY && state->keys_remaining == 0)
+      state->state = ACCESS_LIST_ENTRY;
+    if(chunk->consumed >= chunk->length) return;
+    uint8_t const first = chunk->src[chunk->consumed];
 
-            //
-            PARSE_ITEM(EVM_LEGACY_TXN_STARTGAS, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-
-            uint64_t gasLimit = enforceParsedScalarFits64Bits(&state->rlpItem_state);
-            size_t gasLimitLength = state->rlpItem_state.length;
-            state->gasLimit = gasLimit;
-            // TODO: We don't currently support the C-chain gas limit of 100 million,
-            // which would have a fee larger than what fits in a word
-            if(gasPriceLength + gasLimitLength > 8)
-              REJECT("Fee too large");
-            FINISH_ITEM_CHUNK();
-
-            //
-            fallthrough;
-          case EVM_LEGACY_TXN_TO: {
-            //
-
-            switch (state->per_item_prompt) {
-
-            case 0:
-              JUST_PARSE_ITEM(EVM_LEGACY_TXN_TO, _to_buffer);
-              RET_IF_NEED_MORE;
-              state->per_item_prompt++;
-              RET_IF_PROMPT_FLUSH;
-              fallthrough;
-
-            case 1:
-              switch (state->rlpItem_state.length) {
-              case 0:
-                state->hasTo = false;
-                break;
-              case ETHEREUM_ADDRESS_SIZE:
-                state->hasTo = true;
-                break;
-              default:
-                REJECT("When present, destination address must have exactly %u bytes", ETHEREUM_ADDRESS_SIZE);
-              }
+    switch(state->state) {
+    case ACCESS_LIST_ENTRY:
+    case ACCESS_LIST_KEYS:
+      access_list_consume(state, 1);
+      chunk->consumed++;
+      if(first < 0xc0) REJECT("Access list entries and storage keys must be RLP lists");
+      if(first < 0xf8) {
+        if(state->state == ACCESS_LIST_ENTRY) state->entry_remaining = first - 0xc0;
+        else state->keys_remaining = first - 0xc0;
+        access_list_open(state);
+      } else {
+        // The length is read into the counter of the list being opened, which consume doesn't touch yet
+        state->len_len = first - 0xf7;
+        if(state->state == ACCESS_LIST_ENTRY) state->entry_remaining = 0;
+        else state->keys_remaining = 0;
+        state->state++;
+      }
+      break;
+    case ACCESS_LIST_ENTRY_LENGTH:
+    case ACCESS_LIST_KEYS_LENGTH: {
+      access_list_consume(state, 1);
+      chunk->consumed++;
+      uint64_t *const length = state->state == ACCESS_LIST_ENTRY_LENGTH ? &state->entry_remaining : &state->keys_remaining;
+      *length = (*length << 8) | first;
+      if(--state->len_len == 0) access_list_open(state);
+      break;
+    }
+    case ACCESS_LIST_ADDRESS:
+      access_list_consume(state, 1);
+      chunk->consumed++;
+      if(first != 0x80 + ETHEREUM_ADDRESS_SIZE) REJECT("Access list address must have exactly %u bytes", ETHEREUM_ADDRESS_SIZE);
+      state->skip = ETHEREUM_ADDRESS_SIZE;
+      state->state = ACCESS_LIST_ADDRESS_BYTES;
+      break;
+    case ACCESS_LIST_KEY:
+      access_list_consume(state, 1);
+      chunk->consumed++;
+      if(first != 0x80 + ETHEREUM_WORD_SIZE) REJECT("Storage key must have exactly %u bytes", ETHEREUM_WORD_SIZE);
+      state->skip = ETHEREUM_WORD_SIZE;
+      state->state = ACCESS_LIST_KEY_BYTES;
+      break;
+    case ACCESS_LIST_ADDRESS_BYTES:
+    case ACCESS_LIST_KEY_BYTES: {
+      size_t const n = MIN((size_t)state->skip, chunk->length - chunk->consumed);
+      access_list_consume(state, n);
+      chunk->consumed += n;
+      state->skip -= n;
+      if(state->skip == 0) {
+        if(state->state == ACCESS_LIST_ADDRESS_BYTES) {
+          state->address_count++;
+          state->state = ACCESS_LIST_KEYS;
+        } else {
+          state->storage_key_count++;
+          state->state = ACCESS_LIST_KEY;
+        }
+      }
+      break;
+    }
+    }
+  }
+}
 
-              if(state->hasTo) {
-                for(size_t i = 0; i < NUM_ELEMENTS(precompiled); i++) {
-                  if(!memcmp(precompiled[i].to, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE)) {
-                    meta->known_destination = &precompiled[i];
-                    break;
-                  }
-                }
-                if(!meta->known_destination)
-                  SET_PROMPT_VALUE(memcpy(entry->data.output_prompt.address.val, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE));
-              } else {
-                static char const label []="Creation";
-                ADD_PROMPT("Contract", label, sizeof(label), strcpy_prompt);
-              }
-              state->per_item_prompt++;
-              RET_IF_PROMPT_FLUSH;
-              fallthrough;
-
-            case 2:
-              if (!state->hasTo) {
-                SET_PROMPT_VALUE(entry->data.output_prompt.start_gas = state->gasLimit);
-                ADD_ACCUM_PROMPT("Gas Limit", output_evm_gas_limit_to_string);
-              }
-            }
+// Run after every parse of the access list item with its result, so each
+// chunk is checked as it arrives instead of being buffered.
+void parse_access_list_item(struct EVM_RLP_item_state *const item_state, enum parse_rv const item_rv) {
+  struct EVM_access_list_state *const state = &item_state->access_list_state;
+  if(item_state->state < 2) return; // The length isn't known yet
+  if(!item_state->is_list) REJECT("Access list must be an RLP list");
+  if(item_state->do_init) {
+    memset(state, 0, sizeof(*state));
+    state->state = ACCESS_LIST_ENTRY;
+    state->list_remaining = item_state->length;
+  }
+  parse_access_list_chunk(state, &item_state->chunk);
+  if(item_rv == PARSE_RV_DONE && (state->state != ACCESS_LIST_ENTRY || state->list_remaining != 0))
+    REJECT("Access list ended in the middle of an entry");
+}
 
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
-          }
+// Token information is only trusted on the chain its descriptor was signed for.
+static void check_erc20_chain_id(evm_parser_meta_state_t const *const meta, uint32_t const chain_id) {
+  if(meta->erc20_token && meta->erc20_token->chain_id != chain_id)
+    REJECT("ERC-20 token information is for chain %u, not %u", meta->erc20_token->chain_id, chain_id);
+}
 
-            //
-            PARSE_ITEM(EVM_LEGACY_TXN_VALUE, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
+// Hooks for the RLP transaction items, in the order they usually appear.
+
+static enum parse_rv typed_chain_id_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  if(state->rlpItem_state.length != 2
+     || state->rlpItem_state.buffer[0] != 0xa8
+     || (state->rlpItem_state.buffer[1] != 0x68
+         && state->rlpItem_state.buffer[1] != 0x69
+         && state->rlpItem_state.buffer[1] != 0x6a))
+      REJECT("Chain ID incorrect for the Avalanche C chain");
+  meta->chainIdLowByte = 0; // explicitly clear chain ID low byte for typed transactions - only legacy transactions needed to include it
+  meta->chainId = READ_UNALIGNED_BIG_ENDIAN(uint16_t, state->rlpItem_state.buffer);
+  return PARSE_RV_DONE;
+}
 
-            parse_value_from_txn(state, meta);
+static enum parse_rv fee_per_gas_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  add_fee_per_gas(state);
+  return PARSE_RV_DONE;
+}
 
-            if(state->hasTo) {
-              // As of now, there is no known reason to send AVAX to any precompiled contract we support
-              // Given that, we take the less risky action with the intent of protecting from unintended transfers
-              if(meta->known_destination) {
-                if (!zero256(&state->value))
-                  REJECT("Transactions sent to precompiled contracts must have an amount of 0 WEI");
-              }
-            } else {
-              if (!zero256(&state->value)) {
-                ADD_ACCUM_PROMPT("Funding Contract", output_evm_fund_to_string);
-              }
-            }
+static enum parse_rv gas_limit_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  apply_gas_limit(state);
+  return PARSE_RV_DONE;
+}
 
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
-
-            //
-            fallthrough;
-          case EVM_LEGACY_TXN_DATA: {
-            // Instead of waiting for a complete item parse, do some of the
-            // actions below every time.
-            //
-
-            switch (state->per_item_prompt) {
-            case 0:
-              state->item_rv = PARSE_RV_INVALID;
-              state->sort = TXN_DATA_UNSET;
-              JUST_PARSE_ITEM(EVM_LEGACY_TXN_DATA, _data);
-              state->item_rv = sub_rv;
-              sub_rv = PARSE_RV_INVALID;
-              state->per_item_prompt++;
-              fallthrough;
-            case 1:
-              // Only continue if the initial parse got sufficiently far.
-              checkDataFieldLengthFitsTransaction(state);
-              if (state->rlpItem_state.state < 2) {
-                state->per_item_prompt = 0;
-                return state->item_rv;
-              }
+static enum parse_rv to_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  enum parse_rv sub_rv = PARSE_RV_DONE;
+  switch (state->per_item_prompt) {
+  case 1:
+    switch (state->rlpItem_state.length) {
+    case 0:
+      state->hasTo = false;
+      break;
+    case ETHEREUM_ADDRESS_SIZE:
+      state->hasTo = true;
+      break;
+    default:
+      REJECT("When present, destination address must have exactly %u bytes", ETHEREUM_ADDRESS_SIZE);
+    }
 
-              check_whether_has_calldata(state);
-
-              if (state->sort == TXN_DATA_UNSET) {
-                if(state->hasTo) {
-                  if(meta->known_destination) {
-                    state->sort = TXN_DATA_CONTRACT_CALL_KNOWN_DEST;
-                  } else {
-                    if (state->hasData)
-                      state->sort = TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST;
-                    else {
-                      state->sort = TXN_DATA_PLAIN_TRANSFER;
-                    }
-                  }
-                } else {
-                  state->sort = TXN_DATA_DEPLOY;
-                }
-              }
+    if(state->hasTo) {
+      for(size_t i = 0; i < NUM_ELEMENTS(precompiled); i++) {
+        if(!memcmp(precompiled[i].to, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE)) {
+          meta->known_destination = &precompiled[i];
+          break;
+        }
+      }
+      if(!meta->known_destination) {
+        SET_PROMPT_VALUE(memcpy(entry->data.output_prompt.address.val, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE));
+        meta->erc20_token = erc20_cache_find(state->rlpItem_state.buffer);
+        if(meta->chainId) check_erc20_chain_id(meta, meta->chainId);
+      }
+    } else {
+      static char const label []="Creation";
+      ADD_PROMPT("Contract", label, sizeof(label), strcpy_prompt);
+#ifdef EVM_DATA_HASH
+      cx_keccak_init(&meta->data_hash_state, 256);
+#endif
+    }
+    state->per_item_prompt++;
+    RET_IF_PROMPT_FLUSH;
+    fallthrough;
+  case 2:
+    if (!state->hasTo) {
+      SET_PROMPT_VALUE(entry->data.output_prompt.start_gas = state->gasLimit);
+      ADD_ACCUM_PROMPT("Gas Limit", output_evm_gas_limit_to_string);
+    }
+  }
+  return PARSE_RV_DONE;
+}
 
-              state->per_item_prompt++;
-              fallthrough;
-            case 2:
-
-              switch (state->sort) {
-              case TXN_DATA_UNSET:
-                REJECT("should be known by now");
-
-              case TXN_DATA_CONTRACT_CALL_KNOWN_DEST: {
-                struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
-                if(item_state->do_init && meta->known_destination->init_data) {
-                  PIC(meta->known_destination->init_data)(
-                    &item_state->endpoint_state,
-                    item_state->length);
-                  item_state->do_init = false;
-                }
-                PRINTF("INIT: %u\n", item_state->do_init);
-                PRINTF("Chunk: [%u] %.*h\n",
-                  item_state->chunk.length,
-                  item_state->chunk.length, item_state->chunk.src);
-                if(meta->known_destination->handle_data) {
-                  sub_rv = PIC(meta->known_destination->handle_data)(
-                    &item_state->endpoint_state,
-                    &item_state->chunk,
-                    meta);
-                }
-                break;
-              }
+static enum parse_rv value_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  enum parse_rv sub_rv = PARSE_RV_DONE;
+  if (state->per_item_prompt > 1) return PARSE_RV_DONE; // Resumed after its prompt was flushed
+  state->per_item_prompt++;
+  parse_value_from_txn(state, meta);
+
+  if(state->hasTo) {
+    // As of now, there is no known reason to send AVAX to any precompiled contract we support
+    // Given that, we take the less risky action with the intent of protecting from unintended transfers
+    if(meta->known_destination) {
+      if (!zero256(&state->value))
+        REJECT("Transactions sent to precompiled contracts must have an amount of 0 WEI");
+    }
+  } else {
+    if (!zero256(&state->value)) {
+      ADD_ACCUM_PROMPT("Funding Contract", output_evm_fund_to_string);
+    }
+  }
+  return sub_rv;
+}
 
-              case TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST: {
-                struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
-                struct EVM_ABI_state *const abi_state = &item_state->endpoint_state.abi_state;
-                if(item_state->do_init) {
-                  init_abi_call_data(abi_state, item_state->length);
-                  item_state->do_init = false;
-                }
-
-                sub_rv = parse_abi_call_data(
-                  abi_state,
-                  &item_state->chunk,
-                  meta,
-                  !zero256(&state->value));
-                break;
-              }
+// Runs after every chunk of calldata, handing it to the destination's parser.
+// The fee is known by now for every transaction type, so it's prompted here too.
+static enum parse_rv data_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  enum parse_rv sub_rv = PARSE_RV_DONE;
+  switch (state->per_item_prompt) {
+  case 1:
+    // Only continue if the parse got far enough to know the length.
+    checkDataFieldLengthFitsTransaction(state);
+    if (state->rlpItem_state.state < 2) return state->item_rv;
+
+    check_whether_has_calldata(state);
+
+    if (state->sort == TXN_DATA_UNSET) {
+      if(state->hasTo) {
+        if(meta->known_destination) {
+          state->sort = TXN_DATA_CONTRACT_CALL_KNOWN_DEST;
+        } else {
+          if (state->hasData)
+            state->sort = TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST;
+          else {
+            state->sort = TXN_DATA_PLAIN_TRANSFER;
+          }
+        }
+      } else {
+        state->sort = TXN_DATA_DEPLOY;
+      }
+    }
 
-              case TXN_DATA_DEPLOY:
-              case TXN_DATA_PLAIN_TRANSFER:
-                // Nothing to do each parse
-                break;
-              }
+    state->per_item_prompt++;
+    fallthrough;
+  case 2:
+
+    switch (state->sort) {
+    case TXN_DATA_UNSET:
+      REJECT("should be known by now");
+
+    case TXN_DATA_CONTRACT_CALL_KNOWN_DEST: {
+      // state has To and the destination is known
+      struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
+      if (item_state->do_init && meta->known_destination->init_data) {
+        PIC(meta->known_destination->init_data)(
+          &item_state->endpoint_state,
+          item_state->length);
+        item_state->do_init = false;
+      }
+      PRINTF("INIT: %u\n", item_state->do_init);
+      PRINTF("Chunk: [%u] %.*h\n", item_state->chunk.length, item_state->chunk.length, item_state->chunk.src);
+      if(meta->known_destination->handle_data) {
+        sub_rv = PIC(meta->known_destination->handle_data)(
+          &item_state->endpoint_state,
+          &item_state->chunk,
+          meta);
+      }
+      PRINTF("PARSER CALLED [sub_rv: %u]\n", sub_rv);
+      break;
+    }
+    case TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST: {
+      struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
+      struct EVM_ABI_state *const abi_state = &item_state->endpoint_state.abi_state;
+      if(item_state->do_init) {
+        init_abi_call_data(abi_state, item_state->length);
+        item_state->do_init = false;
+      }
 
-              // At this point we are longer doing *per* chunk work, but back to
-              // the usual case of just doing itmes after the parse before has
-              // completed.
-              if (sub_rv == PARSE_RV_PROMPT) {
-                // DON'T reset per_item_prompt;
-                return PARSE_RV_PROMPT;
-              } else if (sub_rv == PARSE_RV_NEED_MORE) {
-                state->per_item_prompt = 0;
-                return PARSE_RV_NEED_MORE;
-              } else if (state->item_rv == PARSE_RV_PROMPT) {
-                state->per_item_prompt = 3; // Advance to next step!
-                return PARSE_RV_PROMPT;
-              } else if (state->item_rv == PARSE_RV_NEED_MORE) {
-                state->per_item_prompt = 0;
-                return PARSE_RV_NEED_MORE;
-              }
+      sub_rv = parse_abi_call_data(abi_state,
+                                   &item_state->chunk,
+                                   meta,
+                                   !zero256(&state->value));
+      PRINTF("PARSER CALLED [sub_rv: %u]\n", sub_rv);
+      break;
+    }
 
-              state->per_item_prompt++;
-              fallthrough;
-            case 3:
-              switch (state->sort) {
-              case TXN_DATA_UNSET:
-                REJECT("should be known by now");
+    case TXN_DATA_DEPLOY:
+    case TXN_DATA_PLAIN_TRANSFER:
+      // Nothing to do each parse
+      break;
+    }
 
-              case TXN_DATA_PLAIN_TRANSFER: {
-                ADD_ACCUM_PROMPT("Transfer", output_evm_prompt_to_string);
-                break;
-              }
+    // At this point we are longer doing *per* chunk work, but back to
+    // the usual case of just doing items after the parse before has
+    // completed.
+    if (sub_rv == PARSE_RV_PROMPT) {
+      // DON'T reset per_item_prompt;
+      return PARSE_RV_PROMPT;
+    } else if (sub_rv == PARSE_RV_NEED_MORE || state->item_rv == PARSE_RV_NEED_MORE) {
+      return PARSE_RV_NEED_MORE;
+    }
 
-              case TXN_DATA_DEPLOY: {
-                prompt_calldata_preview(state, meta);
-                ADD_ACCUM_PROMPT("Data", output_evm_calldata_preview_to_string);
-                break;
-              }
+    state->per_item_prompt++;
+    fallthrough;
+  case 3:
 
-              default:
-                break;
-              }
+    switch (state->sort) {
+    case TXN_DATA_UNSET:
+      REJECT("should be known by now");
 
-              FINISH_ITEM_CHUNK();
-              RET_IF_PROMPT_FLUSH;
-            }
-          }
+    case TXN_DATA_PLAIN_TRANSFER: {
+      ADD_ACCUM_PROMPT("Transfer", output_evm_prompt_to_string);
+      break;
+    }
 
-            //
-            PARSE_ITEM(EVM_LEGACY_TXN_CHAINID, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
+    case TXN_DATA_DEPLOY: {
+      prompt_calldata_preview(state, meta);
+      ADD_ACCUM_PROMPT("Data", output_evm_calldata_preview_to_string);
+      break;
+    }
 
-            meta->chainIdLowByte = state->rlpItem_state.buffer[state->rlpItem_state.length-1];
-            PRINTF("Chain ID low byte: %x\n", meta->chainIdLowByte);
+    default:
+      break;
+    }
 
-            SET_PROMPT_VALUE(entry->data.output_prompt.fee = state->priorityFeePerGas * state->gasLimit);
-            if(state->hasData) {
-              ADD_ACCUM_PROMPT("Maximum Fee", output_evm_fee_to_string);
-            }
-            else {
-              ADD_ACCUM_PROMPT("Fee", output_evm_fee_to_string);
-            }
+    state->per_item_prompt++;
+    RET_IF_PROMPT_FLUSH;
+    fallthrough;
+  case 4:
+#ifdef EVM_DATA_HASH
+    if (state->sort == TXN_DATA_DEPLOY && state->hasData) {
+      SET_PROMPT_VALUE(finish_hash((cx_hash_t *)&meta->data_hash_state,
+                                   (sign_hash_t *)entry->data.output_prompt.bytes32));
+      ADD_ACCUM_PROMPT("Init Code Hash", output_evm_bytes32_to_string);
+    }
+#endif
+
+    state->per_item_prompt++;
+    RET_IF_PROMPT_FLUSH;
+    fallthrough;
+  case 5:
+    SET_PROMPT_VALUE(entry->data.output_prompt.amount_big = state->fee);
+    if (state->sort == TXN_DATA_PLAIN_TRANSFER) {
+      ADD_ACCUM_PROMPT("Fee", output_evm_fee_to_string);
+    } else {
+      ADD_ACCUM_PROMPT("Maximum Fee", output_evm_fee_to_string);
+    }
+  }
+  return PARSE_RV_DONE;
+}
 
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
+// Summarizes a non-empty access list, which is only a gas optimization.
+static enum parse_rv access_list_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  enum parse_rv sub_rv = state->item_rv;
+  parse_access_list_item(&state->rlpItem_state, sub_rv);
+  RET_IF_NOT_DONE;
+
+  struct EVM_access_list_state const *const access_list = &state->rlpItem_state.access_list_state;
+  if(access_list->address_count > 0) {
+    SET_PROMPT_VALUE(entry->data.output_prompt.access_list.addresses = access_list->address_count);
+    SET_PROMPT_VALUE(entry->data.output_prompt.access_list.storage_keys = access_list->storage_key_count);
+    ADD_ACCUM_PROMPT("Access List", output_evm_access_list_to_string);
+  }
+  return PARSE_RV_DONE;
+}
 
-            //
-            PARSE_ITEM(EVM_LEGACY_TXN_SIG_R, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
+static enum parse_rv eip155_chain_id_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  if(state->rlpItem_state.length == 0) REJECT("Chain ID is required for signing with EIP-155.");
+  meta->chainIdLowByte = state->rlpItem_state.buffer[state->rlpItem_state.length-1];
+  PRINTF("Chain ID low byte: %x\n", meta->chainIdLowByte);
+  if(meta->erc20_token) {
+    if(state->rlpItem_state.length > sizeof(uint32_t)) REJECT("Chain ID too large for ERC-20 token information");
+    uint32_t chain_id = 0;
+    for(size_t i = 0; i < state->rlpItem_state.length; i++) chain_id = chain_id << 8 | state->rlpItem_state.buffer[i];
+    check_erc20_chain_id(meta, chain_id);
+  }
+  return PARSE_RV_DONE;
+}
 
-            if(state->rlpItem_state.length != 0) REJECT("R value must be 0 for signing with EIP-155.");
+static enum parse_rv eip155_signature_parsed(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+  if(state->rlpItem_state.length != 0) REJECT("R and S values must be 0 for signing with EIP-155.");
+  return PARSE_RV_DONE;
+}
 
-            FINISH_ITEM_CHUNK();
+static struct evm_rlp_field const legacy_fields[] = {
+  EVM_RLP_FIELD(SCALAR,   NONE,     NULL),                    // nonce
+  EVM_RLP_FIELD(SCALAR,   WORD,     fee_per_gas_parsed),      // gas price
+  EVM_RLP_FIELD(SCALAR,   WORD,     gas_limit_parsed),        // start gas
+  EVM_RLP_FIELD(SCALAR,   WORD,     to_parsed),               // to
+  EVM_RLP_FIELD(SCALAR,   WORD,     value_parsed),            // value
+  EVM_RLP_FIELD(STREAMED, CALLDATA, data_parsed),             // data
+  EVM_RLP_FIELD(SCALAR,   WORD,     eip155_chain_id_parsed),  // chain ID
+  EVM_RLP_FIELD(SCALAR,   WORD,     eip155_signature_parsed), // r
+  EVM_RLP_FIELD(SCALAR,   WORD,     eip155_signature_parsed), // s
+  EVM_RLP_FIELDS_END
+};
 
-            //
-            PARSE_ITEM(EVM_LEGACY_TXN_SIG_S, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
+static struct evm_rlp_field const eip1559_fields[] = {
+  EVM_RLP_FIELD(SCALAR,   WORD,     typed_chain_id_parsed),   // chain ID
+  EVM_RLP_FIELD(SCALAR,   NONE,     NULL),                    // nonce
+  EVM_RLP_FIELD(SCALAR,   WORD,     fee_per_gas_parsed),      // max priority fee per gas
+  EVM_RLP_FIELD(SCALAR,   WORD,     fee_per_gas_parsed),      // max fee per gas
+  EVM_RLP_FIELD(SCALAR,   WORD,     gas_limit_parsed),        // gas limit
+  EVM_RLP_FIELD(SCALAR,   WORD,     to_parsed),               // to
+  EVM_RLP_FIELD(SCALAR,   WORD,     value_parsed),            // value
+  EVM_RLP_FIELD(STREAMED, CALLDATA, data_parsed),             // data
+  EVM_RLP_FIELD(STREAMED, NONE,     access_list_parsed),      // access list
+  EVM_RLP_FIELDS_END
+};
 
-            if(state->rlpItem_state.length != 0) REJECT("S value must be 0 for signing with EIP-155.");
-            FINISH_ITEM_CHUNK();
-          }
+static struct evm_rlp_field const eip2930_fields[] = {
+  EVM_RLP_FIELD(SCALAR,   WORD,     typed_chain_id_parsed),   // chain ID
+  EVM_RLP_FIELD(SCALAR,   NONE,     NULL),                    // nonce
+  EVM_RLP_FIELD(SCALAR,   WORD,     fee_per_gas_parsed),      // gas price
+  EVM_RLP_FIELD(SCALAR,   WORD,     gas_limit_parsed),        // gas limit
+  EVM_RLP_FIELD(SCALAR,   WORD,     to_parsed),               // to
+  EVM_RLP_FIELD(SCALAR,   WORD,     value_parsed),            // value
+  EVM_RLP_FIELD(STREAMED, CALLDATA, data_parsed),             // data
+  EVM_RLP_FIELD(STREAMED, NONE,     access_list_parsed),      // access list
+  EVM_RLP_FIELDS_END
+};
 
-          if(state->remaining == 0) {
-              state->state = 3;
-              return PARSE_RV_DONE;
-          } else {
-              REJECT("Reported total size of transaction did not match sum of pieces, remaining: %d", state->remaining);
-          }
+static size_t rlp_buffer_size(struct EVM_RLP_txn_state const *const state, uint8_t const policy) {
+  switch (policy) {
+  case EVM_RLP_BUFFER_WORD:
+    return NUM_ELEMENTS(state->rlpItem_state.buffer);
+  case EVM_RLP_BUFFER_CALLDATA:
+    return state->hasTo ? 0 : MAX_CALLDATA_PREVIEW;
+  default:
+    return 0;
+  }
+}
+
+static enum parse_rv parse_rlp_txn_items(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta,
+                                         struct evm_rlp_field const *const fields) {
+  enum parse_rv sub_rv = PARSE_RV_INVALID;
+  while (fields[state->item_index].kind != EVM_RLP_END) {
+    struct evm_rlp_field const *const field = &fields[state->item_index];
+
+    if (state->per_item_prompt == 0) {
+      size_t const itemStartIdx = meta->input.consumed;
+#ifdef EVM_DATA_HASH
+      uint64_t const itemStartCurrent = state->rlpItem_state.current;
+#endif
+      PRINTF("Entering item %u\n", state->item_index);
+      state->item_rv = impl_parse_rlp_item(&state->rlpItem_state, meta, rlp_buffer_size(state, field->buffer));
+      size_t const to_sub = meta->input.consumed - itemStartIdx;
+      if (to_sub > state->remaining) {
+        REJECT("consumed too much parsing item: remaining: %d, this item: %d", state->remaining, to_sub);
       }
-      case 3:
-        sub_rv = PARSE_RV_DONE;
-        return sub_rv;
-      default:
-        REJECT("Transaction parser in supposedly unreachable state");
+      state->remaining -= to_sub;
+#ifdef EVM_DATA_HASH
+      if (field->buffer == EVM_RLP_BUFFER_CALLDATA && !state->hasTo) {
+        // The body is always the tail of what was consumed, after any header
+        size_t const body = state->rlpItem_state.current - itemStartCurrent;
+        cx_hash((cx_hash_t *)&meta->data_hash_state, 0, &meta->input.src[meta->input.consumed - body], body, NULL, 0);
+      }
+#endif
+      if (field->kind == EVM_RLP_SCALAR && state->item_rv != PARSE_RV_DONE) return state->item_rv;
+      state->per_item_prompt = 1;
     }
-    return sub_rv;
+
+    if (field->hook) {
+      sub_rv = PIC(field->hook)(state, meta);
+    } else {
+      sub_rv = state->item_rv;
+    }
+    if (sub_rv == PARSE_RV_NEED_MORE) {
+      state->per_item_prompt = 0;
+      return sub_rv;
+    }
+    RET_IF_NOT_DONE;
+
+    FINISH_ITEM_CHUNK();
+    // Hooks leave a full batch behind when their last prompt fills it
+    if (should_flush(&meta->prompt)) return PARSE_RV_PROMPT;
+  }
+
+  if(state->remaining != 0)
+    REJECT("Reported total size of transaction did not match sum of pieces, remaining: %d", state->remaining);
+  state->state = 3;
+  return PARSE_RV_DONE;
 }
 
-enum parse_rv parse_eip1559_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
+enum parse_rv parse_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
     enum parse_rv sub_rv;
     switch(state->state) {
       case 0: {
@@ -703,7 +898,7 @@ enum parse_rv parse_eip1559_rlp_txn(struct EVM_RLP_txn_state *const state, evm_p
               state->state=1;
           }
         }
-        fallthrough;
+        fallthrough; // NOTE
       case 1:
         if(state->state==1) {
             // Max length we could get for this value is 8 bytes so uint64_state is appropriate.
@@ -715,337 +910,22 @@ enum parse_rv parse_eip1559_rlp_txn(struct EVM_RLP_txn_state *const state, evm_p
         }
         init_rlp_item(&state->rlpItem_state);
         state->state = 2;
-        fallthrough;
-      case 2: { // Now parse items.
-          uint8_t itemStartIdx;
-          switch(state->item_index) {
-            //
-            PARSE_ITEM_FIRST(EVM_EIP1559_TXN_CHAINID, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-
-            if(state->rlpItem_state.length != 2
-               || state->rlpItem_state.buffer[0] != 0xa8
-               || (state->rlpItem_state.buffer[1] != 0x68
-                   && state->rlpItem_state.buffer[1] != 0x69
-                   && state->rlpItem_state.buffer[1] != 0x6a))
-                REJECT("Chain ID incorrect for the Avalanche C chain");
-            meta->chainIdLowByte = 0; // explicitly clear chain ID low byte for EIP1559 transactions - only legacy transactions needed to include it
-
-            FINISH_ITEM_CHUNK();
-
-            //
-            PARSE_ITEM(EVM_EIP1559_TXN_NONCE, );
-            RET_IF_NOT_DONE;
-            //
-
-            FINISH_ITEM_CHUNK();
-
-            //TODO: now that there's 256 bit support,
-            // rather than enforcing the length requirement,
-            // the below code block could instead load the values into
-            // 256 bit values before multiplication.
-            // Getting rid of the intermediate lengths would also allow
-            // sharing the code between PARSE_ITEM and FINISH_ITEM_CHUNK
-            // between legacy and non-legacy transaction parsers.
-            PARSE_ITEM(EVM_EIP1559_TXN_MAX_PRIORITY_FEE_PER_GAS, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-            uint64_t maxFeePerGas = enforceParsedScalarFits64Bits(&state->rlpItem_state);
-            state->priorityFeePerGas = maxFeePerGas;
-            FINISH_ITEM_CHUNK();
-
-            //
-            PARSE_ITEM(EVM_EIP1559_TXN_MAX_FEE_PER_GAS, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-            uint64_t baseFeePerGas = enforceParsedScalarFits64Bits(&state->rlpItem_state);
-            state->baseFeePerGas = baseFeePerGas;
-            FINISH_ITEM_CHUNK();
-
-            //
-            PARSE_ITEM(EVM_EIP1559_TXN_GAS_LIMIT, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-            uint64_t gasLimit = enforceParsedScalarFits64Bits(&state->rlpItem_state);
-            state->gasLimit = gasLimit;
-
-            {
-              uint64_t feeDummy = 0;
-              if(__builtin_mul_overflow(state->priorityFeePerGas + state->baseFeePerGas, state->gasLimit, &feeDummy))
-                REJECT("Fee calculation overflowed");
-            }
-
-            FINISH_ITEM_CHUNK();
-
-            //
-            fallthrough;
-          case EVM_EIP1559_TXN_TO:
-            // Instead of waiting for a complete item parse, do some of the
-            // actions below every time.
-            //
-
-            switch (state->per_item_prompt) {
-            case 0:
-              JUST_PARSE_ITEM(EVM_EIP1559_TXN_TO, _to_buffer);
-              RET_IF_NEED_MORE;
-              state->per_item_prompt++;
-              RET_IF_PROMPT_FLUSH;
-              fallthrough;
-            case 1:
-              switch (state->rlpItem_state.length) {
-              case 0:
-                state->hasTo = false;
-                break;
-              case ETHEREUM_ADDRESS_SIZE:
-                state->hasTo = true;
-                break;
-              default:
-                REJECT("When present, destination address must have exactly %u bytes", ETHEREUM_ADDRESS_SIZE);
-              }
-              state->per_item_prompt++;
-              fallthrough;
-            case 2:
-              if(state->hasTo) {
-                for(size_t i = 0; i < NUM_ELEMENTS(precompiled); i++) {
-                  if(!memcmp(precompiled[i].to, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE)) {
-                    meta->known_destination = &precompiled[i];
-                    break;
-                  }
-                }
-                if(!meta->known_destination)
-                  SET_PROMPT_VALUE(memcpy(entry->data.output_prompt.address.val, state->rlpItem_state.buffer, ETHEREUM_ADDRESS_SIZE));
-              }
-              else {
-                static char const label []="Creation";
-                ADD_PROMPT("Contract", label, sizeof(label), strcpy_prompt);
-              }
-              state->per_item_prompt++;
-              RET_IF_PROMPT_FLUSH;
-              fallthrough;
-            case 3:
-              if (!state->hasTo) {
-                SET_PROMPT_VALUE(entry->data.output_prompt.start_gas = state->gasLimit);
-                ADD_ACCUM_PROMPT("Gas Limit", output_evm_gas_limit_to_string);
-              }
-            }
-
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
-
-            //
-            PARSE_ITEM(EVM_EIP1559_TXN_VALUE, _to_buffer);
-            RET_IF_NOT_DONE;
-            //
-
-            parse_value_from_txn(state, meta);
-
-            if(state->hasTo) {
-              // As of now, there is no known reason to send AVAX to any precompiled contract we support
-              // Given that, we take the less risky action with the intent of protecting from unintended transfers
-              if(meta->known_destination) {
-                if (!zero256(&state->value))
-                  REJECT("Transactions sent to precompiled contracts must have an amount of 0 WEI");
-              }
-            } else {
-              if (!zero256(&state->value)) {
-                ADD_ACCUM_PROMPT("Funding Contract", output_evm_fund_to_string);
-              }
-            }
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
-
-            //
-            fallthrough;
-          case EVM_EIP1559_TXN_DATA: {
-            // Instead of waiting for a complete item parse, do some of the
-            // actions below every time.
-            //
-
-            switch (state->per_item_prompt) {
-            case 0:
-              state->item_rv = PARSE_RV_INVALID;
-              state->sort = TXN_DATA_UNSET;
-              JUST_PARSE_ITEM(EVM_EIP1559_TXN_DATA, _data);
-              state->item_rv = sub_rv;
-              sub_rv = PARSE_RV_INVALID;
-              state->per_item_prompt++;
-              fallthrough;
-            case 1:
-              // Only continue if the initial parse got sufficiently far.
-              if (state->rlpItem_state.state < 2) {
-                state->per_item_prompt = 0;
-                return state->item_rv;
-              }
-
-              check_whether_has_calldata(state);
-
-              if (state->sort == TXN_DATA_UNSET) {
-                if(state->hasTo) {
-                  if(meta->known_destination) {
-                    state->sort = TXN_DATA_CONTRACT_CALL_KNOWN_DEST;
-                  } else {
-                    if (state->hasData)
-                      state->sort = TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST;
-                    else {
-                      state->sort = TXN_DATA_PLAIN_TRANSFER;
-                    }
-                  }
-                } else {
-                  state->sort = TXN_DATA_DEPLOY;
-                }
-              }
-
-              state->per_item_prompt++;
-              fallthrough;
-            case 2:
-
-              switch (state->sort) {
-              case TXN_DATA_UNSET:
-                REJECT("should be known by now");
-
-              case TXN_DATA_CONTRACT_CALL_KNOWN_DEST: {
-                // state has To and the destination is known
-                struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
-                if (item_state->do_init && meta->known_destination->init_data) {
-                  PIC(meta->known_destination->init_data)(
-                    &item_state->endpoint_state,
-                    item_state->length);
-                  item_state->do_init = false;
-                }
-                PRINTF("INIT: %u\n", item_state->do_init);
-                PRINTF("Chunk: [%u] %.*h\n", item_state->chunk.length, item_state->chunk.length, item_state->chunk.src);
-                if(meta->known_destination->handle_data) {
-                  PRINTF("HANDLING DATA\n");
-                  sub_rv = PIC(meta->known_destination->handle_data)(
-                    &item_state->endpoint_state,
-                    &item_state->chunk,
-                    meta);
-                }
-                PRINTF("PARSER CALLED [sub_rv: %u]\n", sub_rv);
-                break;
-              }
-              case TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST: {
-                struct EVM_RLP_item_state *const item_state = &state->rlpItem_state;
-                struct EVM_ABI_state *const abi_state = &item_state->endpoint_state.abi_state;
-                if(item_state->do_init) {
-                  init_abi_call_data(abi_state, item_state->length);
-                  item_state->do_init = false;
-                }
-
-                sub_rv = parse_abi_call_data(abi_state,
-                                             &item_state->chunk,
-                                             meta,
-                                             !zero256(&state->value));
-                PRINTF("PARSER CALLED [sub_rv: %u]\n", sub_rv);
-                break;
-              }
-
-              case TXN_DATA_DEPLOY:
-              case TXN_DATA_PLAIN_TRANSFER:
-                // Nothing to do each parse
-                break;
-              }
-
-              // At this point we are longer doing *per* chunk work, but back to
-              // the usual case of just doing itmes after the parse before has
-              // completed.
-              if (sub_rv == PARSE_RV_PROMPT) {
-                // DON'T reset per_item_prompt;
-                return PARSE_RV_PROMPT;
-              } else if (sub_rv == PARSE_RV_NEED_MORE) {
-                state->per_item_prompt = 0;
-                return PARSE_RV_NEED_MORE;
-              } else if (state->item_rv == PARSE_RV_NEED_MORE) {
-                state->per_item_prompt = 0;
-                return PARSE_RV_NEED_MORE;
-              } else if (state->item_rv == PARSE_RV_PROMPT) {
-                // DON'T reset per_item_prompt;
-                return PARSE_RV_PROMPT;
-              }
-
-              state->per_item_prompt++;
-              fallthrough;
-            case 3:
-
-#             define CALC_FEE { \
-                uint64_t feeDummy = 0; \
-                __builtin_mul_overflow(state->priorityFeePerGas + state->baseFeePerGas, state->gasLimit, &feeDummy); \
-                SET_PROMPT_VALUE(entry->data.output_prompt.fee = feeDummy); \
-              }
-
-              switch (state->sort) {
-              case TXN_DATA_UNSET:
-                REJECT("should be known by now");
-
-              case TXN_DATA_PLAIN_TRANSFER: {
-                ADD_ACCUM_PROMPT("Transfer", output_evm_prompt_to_string);
-                break;
-              }
-
-              case TXN_DATA_DEPLOY: {
-                prompt_calldata_preview(state, meta);
-                ADD_ACCUM_PROMPT("Data", output_evm_calldata_preview_to_string);
-                break;
-              }
-
-              default:
-                break;
-              }
-
-              state->per_item_prompt++;
-              RET_IF_PROMPT_FLUSH;
-              fallthrough;
-            case 4:
-
-              switch (state->sort) {
-              case TXN_DATA_UNSET:
-                REJECT("should be known by now");
-
-              case TXN_DATA_PLAIN_TRANSFER: {
-                CALC_FEE;
-                ADD_ACCUM_PROMPT("Fee", output_evm_fee_to_string);
-                break;
-              }
-
-              case TXN_DATA_DEPLOY:
-              case TXN_DATA_CONTRACT_CALL_KNOWN_DEST:
-              case TXN_DATA_CONTRACT_CALL_UNKNOWN_DEST: {
-                CALC_FEE;
-                ADD_ACCUM_PROMPT("Maximum Fee", output_evm_fee_to_string);
-                break;
-              }
-              }
-
-            }
-
-            FINISH_ITEM_CHUNK();
-            RET_IF_PROMPT_FLUSH;
-          }
-
-            //
-            PARSE_ITEM(EVM_EIP1559_TXN_ACCESS_LIST, );
-            RET_IF_NOT_DONE;
-            //
-
-            // just ignore this access list
-            FINISH_ITEM_CHUNK();
-          }
-
-          if(state->remaining == 0) {
-              state->state = 3;
-              return PARSE_RV_DONE;
-          } else {
-              REJECT("Reported total size of transaction did not match sum of pieces, remaining: %d", state->remaining);
-          }
-      }
+        fallthrough; // NOTE
+      case 2: // Now parse items.
+        switch(state->type) {
+          case EIP1559:
+            return parse_rlp_txn_items(state, meta, eip1559_fields);
+          case EIP2930:
+            return parse_rlp_txn_items(state, meta, eip2930_fields);
+          case LEGACY:
+          default:
+            return parse_rlp_txn_items(state, meta, legacy_fields);
+        }
       case 3:
-        sub_rv = PARSE_RV_DONE;
-        return sub_rv;
+        return PARSE_RV_DONE;
       default:
         REJECT("Transaction parser in supposedly unreachable state");
     }
-    return sub_rv;
 }
 
 enum parse_rv impl_parse_rlp_item(
@@ -1062,16 +942,21 @@ enum parse_rv impl_parse_rlp_item(
           if(meta->input.consumed >= meta->input.length) return PARSE_RV_NEED_MORE;
           uint8_t const* first_ptr = &meta->input.src[meta->input.consumed++];
           uint8_t first = *first_ptr;
+          state->is_list = first >= 0xc0;
           if(first <= 0x7f) {
               if(max_bytes_to_buffer) {
                 state->buffer[0] = first;
-                state->length = 1;
               }
               else {
                 state->chunk.src = first_ptr;
                 state->chunk.consumed = 0;
                 state->chunk.length = 1;
               }
+              // A finished one byte string, the same as if it had a length prefix
+              state->length = 1;
+              state->current = 1;
+              state->do_init = !max_bytes_to_buffer;
+              state->state = 4;
               return PARSE_RV_DONE;
           } else if (first < 0xb8) {
               state->length = first - 0x80;
@@ -1140,17 +1025,6 @@ enum parse_rv impl_parse_rlp_item(
     return sub_rv;
 }
 
-enum parse_rv parse_rlp_item(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
-  return impl_parse_rlp_item(&state->rlpItem_state, meta, 0);
-}
-
-enum parse_rv parse_rlp_item_to_buffer(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
-  return impl_parse_rlp_item(&state->rlpItem_state, meta, NUM_ELEMENTS(state->rlpItem_state.buffer));
-}
-enum parse_rv parse_rlp_item_data(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta) {
-  return impl_parse_rlp_item(&state->rlpItem_state, meta, state->hasTo ? 0 : MAX_CALLDATA_PREVIEW);
-}
-
 //IMPL_FIXED(uint256_t);
 
 #define ASSETCALL_FIXED_DATA_WIDTH (20 + 32 + 32)
@@ -1167,19 +1041,116 @@ void init_assetCall_data(struct EVM_assetCall_state *const state, uint64_t lengt
 
 _Static_assert(
   (
-    offsetof(union EVM_endpoint_argument_states, uint256_state.buf)
+    offsetof(union EVM_endpoint_argument_states, word_state.buf)
     ==
     offsetof(union EVM_endpoint_argument_states, fixed_state.buffer_)
   ),
   "buffers do not line up in EVM_endpoint_argument_states");
 
 void init_abi_call_data(struct EVM_ABI_state *const state, uint64_t length) {
+  memset(state, 0, sizeof(*state));
   state->state = ABISTATE_SELECTOR;
-  state->argument_index = 0;
   state->data_length = length;
   initFixed(fs(&state->argument_state), sizeof(state->argument_state));
 }
 
+// Binary search of the registry, which the generator sorts by selector
+static struct contract_endpoint const *find_known_endpoint(uint8_t const *const selector) {
+  size_t lo = 0;
+  size_t hi = NUM_ELEMENTS(known_endpoints);
+  while (lo < hi) {
+    size_t const mid = lo + (hi - lo) / 2;
+    int const cmp = memcmp(known_endpoints[mid].selector, selector, ETHEREUM_SELECTOR_SIZE);
+    if (cmp == 0) return &known_endpoints[mid];
+    if (cmp < 0) lo = mid + 1;
+    else hi = mid;
+  }
+  return NULL;
+}
+
+static struct contract_endpoint_param abi_current_parameter(struct EVM_ABI_state const *const state,
+                                                            evm_parser_meta_state_t const *const meta) {
+  return abi_parameters[meta->known_endpoint->parameters[state->argument_index]];
+}
+
+static enum parse_rv prompt_abi_word(evm_parser_meta_state_t *const meta, char const *const name,
+                                     uint8_t const type, uint8_t *const word) {
+  enum parse_rv sub_rv = PARSE_RV_DONE;
+  const struct abi_type_handler handler = abi_type_handlers[type];
+  setup_prompt_fun_t setup_prompt = PIC(handler.setup_prompt);
+  output_prompt_fun_t output_prompt = PIC(handler.output_prompt);
+  SET_PROMPT_VALUE(setup_prompt(word, &entry->data.output_prompt));
+  if(type == ABI_TYPE_AMOUNT && meta->erc20_token) {
+    SET_PROMPT_VALUE(memcpy(&entry->data.output_prompt.erc20_amount.token, &meta->erc20_token->token, sizeof(erc20_token_t)));
+    output_prompt = output_erc20_amount_to_string;
+  }
+  ADD_ACCUM_PROMPT_ABI(name, output_prompt);
+  return sub_rv;
+}
+
+// Offsets and lengths take a whole word, but calldata never needs more than 32 bits of one.
+static uint32_t abi_word_to_u32(uint8_t const *const word) {
+  for (size_t i = 0; i < ETHEREUM_WORD_SIZE - sizeof(uint32_t); i++) {
+    if (word[i]) REJECT("ABI offset or length too large");
+  }
+  return READ_UNALIGNED_BIG_ENDIAN(uint32_t, &word[ETHEREUM_WORD_SIZE - sizeof(uint32_t)]);
+}
+
+static size_t abi_bytes_left(struct EVM_ABI_state const *const state) {
+  return state->data_length - ETHEREUM_SELECTOR_SIZE - state->position;
+}
+
+// Moves on to the tail of the next dynamic argument, which must start where its head said.
+static void abi_next_tail(struct EVM_ABI_state *const state, evm_parser_meta_state_t const *const meta) {
+  while (state->argument_index < meta->known_endpoint->parameters_count
+         && !abi_type_is_dynamic(abi_current_parameter(state, meta).type)) {
+    state->argument_index++;
+  }
+  if (state->argument_index == meta->known_endpoint->parameters_count) {
+    state->state = ABISTATE_DONE;
+    return;
+  }
+  if (state->tail_offsets[state->dynamic_index] != state->position) REJECT("ABI tail is not where its offset points");
+  state->dynamic_index++;
+  state->state = ABISTATE_TAIL_LENGTH;
+}
+
+// Moves on to the next element of an array of dynamic values, or past the array.
+static void abi_next_element(struct EVM_ABI_state *const state, evm_parser_meta_state_t const *const meta) {
+  if (state->element_index == state->element_count) {
+    state->argument_index++;
+    abi_next_tail(state, meta);
+    return;
+  }
+  if (state->element_base + state->tail_offsets[state->dynamic_count + state->element_index] != state->position)
+    REJECT("ABI array element is not where its offset points");
+  state->element_index++;
+  state->state = ABISTATE_ELEMENT_LENGTH;
+}
+
+// The value's bytes go straight into the prompt entry it will be shown in,
+// which is only added to the batch once the value has been read.
+static void begin_abi_value(struct EVM_ABI_state *const state, evm_parser_meta_state_t *const meta,
+                            uint8_t const type, uint32_t const length) {
+  if (length > abi_bytes_left(state)) REJECT("ABI value runs past the end of the calldata");
+  state->remaining = length;
+  state->value_padding = (ETHEREUM_WORD_SIZE - length % ETHEREUM_WORD_SIZE) % ETHEREUM_WORD_SIZE;
+  if (state->value_padding > abi_bytes_left(state) - length) REJECT("ABI value runs past the end of the calldata");
+  SET_PROMPT_VALUE(memset(&entry->data.output_prompt.abi_value, 0, sizeof(entry->data.output_prompt.abi_value)));
+  SET_PROMPT_VALUE(entry->data.output_prompt.abi_value.length = length);
+  SET_PROMPT_VALUE(entry->data.output_prompt.abi_value.is_string = type == ABI_TYPE_STRING);
+#ifdef EVM_DATA_HASH
+  cx_keccak_init(&meta->data_hash_state, 256);
+#endif
+  state->state = ABISTATE_VALUE;
+}
+
+static void abi_value_preview_append(output_prompt_t *const prompt, uint8_t const *const src, size_t const size) {
+  size_t const to_copy = MIN(size, (size_t)(ABI_VALUE_PREVIEW_SIZE - prompt->abi_value.count));
+  memcpy(&prompt->abi_value.preview[prompt->abi_value.count], src, to_copy);
+  prompt->abi_value.count += to_copy;
+}
+
 enum parse_rv parse_abi_call_data(struct EVM_ABI_state *const state,
                                   parser_input_meta_state_t *const input,
                                   evm_parser_meta_state_t *const meta,
@@ -1192,19 +1163,14 @@ rebranch:
   case ABISTATE_SELECTOR: {
     sub_rv = parseFixed(fs(&state->selector_state), input, ETHEREUM_SELECTOR_SIZE);
     BREAK_IF_NOT_DONE;
-    for(size_t i = 0; i < NUM_ELEMENTS(known_endpoints); i++) {
-      if(!memcmp(&known_endpoints[i].selector, state->selector_state.buf, ETHEREUM_SELECTOR_SIZE)) {
-        meta->known_endpoint = &known_endpoints[i];
-        break;
-      }
-    }
+    meta->known_endpoint = find_known_endpoint(state->selector_state.buf);
 
     if(meta->known_endpoint) {
-      state->state = ABISTATE_ARGUMENTS;
-      initFixed(fs(&state->argument_state), sizeof(state->argument_state));
-      if(hasValue) REJECT("No currently supported methods are marked as 'payable'");
-      char *method_name = PIC(meta->known_endpoint->method_name);
-      ADD_PROMPT("Contract Call", method_name, strlen(method_name), strcpy_prompt);
+      state->state = ABISTATE_METHOD;
+      if(hasValue) {
+        if(!meta->known_endpoint->payable) REJECT("Method is not marked as 'payable'");
+        ADD_ACCUM_PROMPT("Transfer", output_evm_prompt_to_string);
+      }
     } else {
       state->state = ABISTATE_UNRECOGNIZED;
       ADD_ACCUM_PROMPT("Transfer", output_evm_prompt_to_string);
@@ -1214,22 +1180,156 @@ rebranch:
     goto rebranch;
   }
 
+  case ABISTATE_METHOD: {
+    sub_rv = PARSE_RV_DONE;
+    state->state = ABISTATE_ARGUMENTS;
+    initFixed(fs(&state->argument_state), sizeof(state->argument_state));
+    char *method_name = PIC(meta->known_endpoint->method_name);
+    ADD_PROMPT("Contract Call", method_name, strlen(method_name) + 1, strcpy_prompt);
+    BREAK_IF_NOT_DONE;
+    goto rebranch;
+  }
+
+  // Static arguments are shown as their heads go by. Dynamic ones only leave
+  // an offset here, and are shown from their tails once every head is read.
   case ABISTATE_ARGUMENTS: {
+    sub_rv = PARSE_RV_DONE; // Methods without parameters skip the loop
     while (state->argument_index < meta->known_endpoint->parameters_count) {
-      sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE); // TODO: non-word size values
+      sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE);
       BREAK_IF_NOT_DONE;
-      const struct contract_endpoint_param parameter = meta->known_endpoint->parameters[state->argument_index];
-      char *argument_name = PIC(parameter.name);
-      setup_prompt_fun_t setup_prompt = PIC(parameter.setup_prompt);
-      SET_PROMPT_VALUE(setup_prompt(fs(&state->argument_state)->buffer,
-                                    &entry->data.output_prompt));
+      state->position += ETHEREUM_WORD_SIZE;
+      const struct contract_endpoint_param parameter = abi_current_parameter(state, meta);
+      if (abi_type_is_dynamic(parameter.type)) {
+        if (state->dynamic_count >= ABI_MAX_TAIL_OFFSETS) REJECT("Too many dynamic ABI arguments");
+        state->tail_offsets[state->dynamic_count++] = abi_word_to_u32(state->argument_state.word_state.buf);
+      } else {
+        sub_rv = prompt_abi_word(meta, PIC(parameter.name), parameter.type, state->argument_state.word_state.buf);
+      }
       initFixed(fs(&state->argument_state), sizeof(state->argument_state));
-      ADD_ACCUM_PROMPT_ABI(argument_name, PIC(parameter.output_prompt));
       state->argument_index++;
       BREAK_IF_NOT_DONE;
     }
     BREAK_IF_NOT_DONE;
-    state->state = ABISTATE_DONE;
+    state->argument_index = 0;
+    abi_next_tail(state, meta);
+    goto rebranch;
+  }
+
+  case ABISTATE_TAIL_LENGTH: {
+    sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE);
+    BREAK_IF_NOT_DONE;
+    state->position += ETHEREUM_WORD_SIZE;
+    uint32_t const length = abi_word_to_u32(state->argument_state.word_state.buf);
+    initFixed(fs(&state->argument_state), sizeof(state->argument_state));
+    const struct contract_endpoint_param parameter = abi_current_parameter(state, meta);
+
+    if (!(parameter.type & ABI_TYPE_ARRAY)) {
+      begin_abi_value(state, meta, parameter.type, length);
+    } else if (length == 0) {
+      static char const emptyLabel[] = "Empty";
+      SET_PROMPT_VALUE(memcpy(&entry->data, emptyLabel, sizeof(emptyLabel)));
+      ADD_ACCUM_PROMPT_ABI(PIC(parameter.name), strcpy_prompt);
+      state->argument_index++;
+      abi_next_tail(state, meta);
+      BREAK_IF_NOT_DONE;
+    } else if (length > abi_bytes_left(state) / ETHEREUM_WORD_SIZE) {
+      REJECT("ABI array runs past the end of the calldata");
+    } else if (abi_type_is_dynamic(ABI_ELEMENT_TYPE(parameter.type))) {
+      // Element offsets are kept until each element is reached
+      if (length > ABI_MAX_TAIL_OFFSETS - state->dynamic_count) REJECT("Too many dynamic values in an ABI array");
+      state->element_count = length;
+      state->element_index = 0;
+      state->remaining = length;
+      state->element_base = state->position;
+      state->state = ABISTATE_ELEMENT_OFFSETS;
+    } else {
+      state->remaining = length;
+      state->state = ABISTATE_ELEMENTS;
+    }
+    goto rebranch;
+  }
+
+  case ABISTATE_ELEMENTS: {
+    const struct contract_endpoint_param parameter = abi_current_parameter(state, meta);
+    sub_rv = PARSE_RV_DONE;
+    while (state->remaining > 0) {
+      sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE);
+      BREAK_IF_NOT_DONE;
+      state->position += ETHEREUM_WORD_SIZE;
+      state->remaining--;
+      sub_rv = prompt_abi_word(meta, PIC(parameter.name), ABI_ELEMENT_TYPE(parameter.type), state->argument_state.word_state.buf);
+      initFixed(fs(&state->argument_state), sizeof(state->argument_state));
+      BREAK_IF_NOT_DONE;
+    }
+    BREAK_IF_NOT_DONE;
+    state->argument_index++;
+    abi_next_tail(state, meta);
+    goto rebranch;
+  }
+
+  case ABISTATE_ELEMENT_OFFSETS: {
+    sub_rv = PARSE_RV_DONE;
+    while (state->remaining > 0) {
+      sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE);
+      BREAK_IF_NOT_DONE;
+      state->position += ETHEREUM_WORD_SIZE;
+      uint32_t const offset = abi_word_to_u32(state->argument_state.word_state.buf);
+      initFixed(fs(&state->argument_state), sizeof(state->argument_state));
+      state->tail_offsets[state->dynamic_count + state->element_count - state->remaining] = offset;
+      state->remaining--;
+    }
+    BREAK_IF_NOT_DONE;
+    abi_next_element(state, meta);
+    goto rebranch;
+  }
+
+  case ABISTATE_ELEMENT_LENGTH: {
+    sub_rv = parseFixed(fs(&state->argument_state), input, ETHEREUM_WORD_SIZE);
+    BREAK_IF_NOT_DONE;
+    state->position += ETHEREUM_WORD_SIZE;
+    uint32_t const length = abi_word_to_u32(state->argument_state.word_state.buf);
+    initFixed(fs(&state->argument_state), sizeof(state->argument_state));
+    begin_abi_value(state, meta, ABI_ELEMENT_TYPE(abi_current_parameter(state, meta).type), length);
+    goto rebranch;
+  }
+
+  case ABISTATE_VALUE: {
+    uint8_t const *const src = &input->src[input->consumed];
+    size_t const value_bytes = MIN(input->length - input->consumed, state->remaining);
+    SET_PROMPT_VALUE(abi_value_preview_append(&entry->data.output_prompt, src, value_bytes));
+#ifdef EVM_DATA_HASH
+    cx_hash((cx_hash_t *)&meta->data_hash_state, 0, src, value_bytes, NULL, 0);
+#endif
+    input->consumed += value_bytes;
+    state->position += value_bytes;
+    state->remaining -= value_bytes;
+
+    while (state->value_padding > 0 && input->consumed < input->length) {
+      if (input->src[input->consumed] != 0) REJECT("ABI value padding is not zero");
+      input->consumed++;
+      state->position++;
+      state->value_padding--;
+    }
+    if (state->remaining > 0 || state->value_padding > 0) {
+      sub_rv = PARSE_RV_NEED_MORE;
+      break;
+    }
+
+    const struct contract_endpoint_param parameter = abi_current_parameter(state, meta);
+#ifdef EVM_DATA_HASH
+    // Only shown when the preview doesn't hold the whole value
+    SET_PROMPT_VALUE(finish_hash((cx_hash_t *)&meta->data_hash_state, (sign_hash_t *)entry->data.output_prompt.abi_value.hash));
+    SET_PROMPT_VALUE(entry->data.output_prompt.abi_value.hashed = true);
+#endif
+    sub_rv = PARSE_RV_DONE;
+    ADD_ACCUM_PROMPT_ABI(PIC(parameter.name), output_evm_abi_value_to_string);
+    if (parameter.type & ABI_TYPE_ARRAY) {
+      abi_next_element(state, meta);
+    } else {
+      state->argument_index++;
+      abi_next_tail(state, meta);
+    }
+    BREAK_IF_NOT_DONE;
     goto rebranch;
   }
 
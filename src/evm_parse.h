@@ -4,8 +4,7 @@
 
 union EVM_endpoint_argument_states {
   struct FixedState0 fixed_state;
-  struct uint256_t_state uint256_state;
-  struct Address_state address_state;
+  struct Id32_state word_state;
 };
 
 enum assetCall_state_t {
@@ -33,15 +32,37 @@ struct EVM_assetCall_state {
 
 enum abi_state_t {
   ABISTATE_SELECTOR,
-  ABISTATE_ARGUMENTS,
+  ABISTATE_METHOD,
+  ABISTATE_ARGUMENTS,       // Head words: static values, and offsets of dynamic ones
+  ABISTATE_TAIL_LENGTH,     // Length word of a dynamic argument
+  ABISTATE_ELEMENTS,        // Words of an array of static values
+  ABISTATE_ELEMENT_OFFSETS, // Offsets of an array of dynamic values
+  ABISTATE_ELEMENT_LENGTH,  // Length word of one of those values
+  ABISTATE_VALUE,           // Bytes of a bytes or string value, then its padding
   ABISTATE_UNRECOGNIZED,
   ABISTATE_DONE,
 };
 
+// Offsets held at once: those of the method's dynamic arguments, followed by
+// those of the elements of the array of dynamic values being read
+#define ABI_MAX_TAIL_OFFSETS 6
+
+// Tails are read as they stream in, so each must start exactly where its
+// offset says: the encoding has to be the canonical one, with tails in
+// argument order and no gaps. Positions count from the end of the selector.
 struct EVM_ABI_state {
   enum abi_state_t state;
-  size_t argument_index;
+  uint8_t argument_index;
+  uint8_t dynamic_count; // Offsets of dynamic arguments at the start of tail_offsets
+  uint8_t dynamic_index; // Next of them whose tail is due
+  uint8_t element_count; // Elements of the array of dynamic values being read
+  uint8_t element_index;
+  uint8_t value_padding; // Zero bytes left after the value
   size_t data_length;
+  uint32_t position;
+  uint32_t remaining; // Words left of an array, or bytes left of a value
+  uint32_t element_base; // Where the array's element offsets count from
+  uint32_t tail_offsets[ABI_MAX_TAIL_OFFSETS];
   union {
     struct uint32_t_state selector_state;
     union EVM_endpoint_argument_states argument_state;
@@ -67,12 +88,28 @@ struct known_destination {
   known_destination_parser handle_data;
 };
 
+// Contract creations show a Keccak-256 digest of their whole init code, not
+// just the calldata preview, and long bytes and string arguments of contract
+// calls show one of their value. Nano S can't spare a second Keccak state next
+// to the transaction hash, so it only shows the previews.
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define EVM_DATA_HASH
+#endif
+
 struct evm_parser_meta_state {
     parser_input_meta_state_t input;
     uint8_t chainIdLowByte;
+    uint16_t chainId; // Only for typed transactions, whose chain ID comes before the destination
     struct known_destination const *known_destination;
     struct contract_endpoint const *known_endpoint;
+    erc20_cache_entry_t const *erc20_token; // Provided metadata for the destination contract, if any
     prompt_batch_t prompt;
+#ifdef EVM_DATA_HASH
+    cx_sha3_t data_hash_state; // Init code, or the ABI value being read, hashed as it streams in
+#endif
+#ifdef AVA_PARSE_STATS
+    parse_stats_t stats;
+#endif
 };
 
 void initTransaction(struct TransactionState *const state);
@@ -81,25 +118,54 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
 
 #define MAX_EVM_BUFFER 32
 
+enum access_list_state_t {
+  ACCESS_LIST_ENTRY,         // Entry list header, or the end of the access list
+  ACCESS_LIST_ENTRY_LENGTH,  // Long form length of an entry
+  ACCESS_LIST_ADDRESS,       // Address string header
+  ACCESS_LIST_ADDRESS_BYTES,
+  ACCESS_LIST_KEYS,          // Storage keys list header
+  ACCESS_LIST_KEYS_LENGTH,   // Long form length of the storage keys
+  ACCESS_LIST_KEY,           // Storage key string header, or the end of the storage keys
+  ACCESS_LIST_KEY_BYTES,
+};
+
+// Streaming decoder for [[address, [storage key, ...]], ...]. Every level
+// keeps the bytes it has left, so nothing of the list is ever buffered.
+struct EVM_access_list_state {
+  enum access_list_state_t state;
+  uint8_t len_len;
+  uint8_t skip; // Bytes left of the address or storage key being read
+  uint64_t list_remaining;
+  uint64_t entry_remaining;
+  uint64_t keys_remaining;
+  uint32_t address_count;
+  uint32_t storage_key_count;
+};
+
 struct EVM_RLP_item_state {
     int state;
     uint64_t length;
     uint64_t current;
     uint8_t len_len;
     bool do_init;
+    bool is_list;
     union {
         struct uint64_t_state uint64_state;
         uint8_t buffer[MAX_EVM_BUFFER];
         struct {
             parser_input_meta_state_t chunk;
-            union EVM_endpoint_states endpoint_state;
+            union {
+                union EVM_endpoint_states endpoint_state;
+                struct EVM_access_list_state access_list_state;
+            };
         };
     };
 };
 
 enum txn_being_parsed_t {
   LEGACY,
-  EIP1559
+  EIP1559,
+  EIP2930
 };
 
 enum TxnDataSort {
@@ -112,6 +178,7 @@ enum TxnDataSort {
 
 struct EVM_RLP_txn_state {
     int state;
+    enum txn_being_parsed_t type;
     uint64_t remaining;
     uint8_t len_len;
     uint8_t item_index;
@@ -123,8 +190,7 @@ struct EVM_RLP_txn_state {
     bool hasTo;
     bool hasData;
     uint64_t gasLimit;
-    uint64_t priorityFeePerGas;
-    uint64_t baseFeePerGas;
+    uint256_t fee; // Fee per gas until the gas limit is parsed
     uint256_t value;
     union {
         struct uint64_t_state uint64_state;
@@ -141,15 +207,43 @@ struct EVM_txn_state {
     };
 };
 
-void init_rlp_list(struct EVM_RLP_txn_state *const state);
+// Item descriptors for the table-driven RLP transaction parser in
+// evm_parse.c, one table per transaction type.
+
+enum evm_rlp_field_kind {
+  EVM_RLP_END = 0,
+  EVM_RLP_SCALAR,   // The hook runs once the whole item is parsed
+  EVM_RLP_STREAMED, // The hook runs after every chunk, with the parse result in item_rv
+};
+
+enum evm_rlp_buffer_policy {
+  EVM_RLP_BUFFER_NONE,     // Bytes are only passed along as chunks
+  EVM_RLP_BUFFER_WORD,     // Up to MAX_EVM_BUFFER bytes are kept
+  EVM_RLP_BUFFER_CALLDATA, // The calldata preview is kept, and the init code hashed, for contract creations
+};
+
+// Hooks resume from per_item_prompt, which is 1 on their first call, and
+// return PROMPT to be called again after a flush, NEED_MORE for more of the
+// item, or DONE once the item is finished.
+typedef enum parse_rv (*evm_rlp_hook_t)(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
+
+struct evm_rlp_field {
+  uint8_t kind;   // enum evm_rlp_field_kind
+  uint8_t buffer; // enum evm_rlp_buffer_policy
+  evm_rlp_hook_t hook;
+};
+
+#define EVM_RLP_FIELD(kind_, buffer_, hook_) { .kind = EVM_RLP_ ## kind_, .buffer = EVM_RLP_BUFFER_ ## buffer_, .hook = (hook_) }
+#define EVM_RLP_FIELDS_END { .kind = EVM_RLP_END, .buffer = EVM_RLP_BUFFER_NONE, .hook = NULL }
+
+void init_rlp_list(struct EVM_RLP_txn_state *const state, enum txn_being_parsed_t const type);
 
 void init_evm_txn(struct EVM_txn_state *const state);
 
 enum parse_rv parse_evm_txn(struct EVM_txn_state *const state, evm_parser_meta_state_t *const meta);
 
-enum parse_rv parse_eip1559_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
-
-enum parse_rv parse_legacy_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
+// Parses the RLP list of any transaction type, following the item table of state->type.
+enum parse_rv parse_rlp_txn(struct EVM_RLP_txn_state *const state, evm_parser_meta_state_t *const meta);
 
 void strcpy_prompt(char *const out, size_t const out_size, char const *const in);
 
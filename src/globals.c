@@ -1,6 +1,8 @@
 #include "globals.h"
 
 #include "exception.h"
+#include "profile.h"
+#include "trace.h"
 #include "to_string.h"
 
 #if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
@@ -29,6 +31,20 @@ void __attribute__ ((noinline)) dbgout(char *at) {
 
 globals_t global;
 
+#ifdef AVA_PROFILE
+uint32_t profile_calls[PROFILE_REGION_COUNT];
+uint32_t profile_wait_ticks[PROFILE_WAIT_COUNT];
+uint8_t profile_waiting;
+#endif
+
+#ifdef AVA_TRACE
+trace_ring_t trace_ring;
+#endif
+
+#ifdef AVA_PARSE_STATS
+parse_stats_t last_parse_stats;
+#endif
+
 // These are strange variables that the SDK relies on us to define but uses directly itself.
 ux_state_t G_ux;
 bolos_ux_params_t G_ux_params;
@@ -38,6 +54,7 @@ unsigned char G_io_seproxyhal_spi_buffer[IO_SEPROXYHAL_BUFFER_SIZE_B];
 void clear_apdu_globals(void) {
     PRINTF("Clearing APDU globals\n");
     memset(&global.apdu, 0, sizeof(global.apdu));
+    precompute_key_clear();
 }
 
 void init_globals(void) {
@@ -47,6 +64,20 @@ void init_globals(void) {
     memset(&G_ux_params, 0, sizeof(G_ux_params));
 
     memset(G_io_seproxyhal_spi_buffer, 0, sizeof(G_io_seproxyhal_spi_buffer));
+
+#ifdef AVA_PROFILE
+    memset(profile_calls, 0, sizeof(profile_calls));
+    memset(profile_wait_ticks, 0, sizeof(profile_wait_ticks));
+    profile_waiting = PROFILE_WAIT_TRANSPORT;
+#endif
+
+#ifdef AVA_TRACE
+    memset(&trace_ring, 0, sizeof(trace_ring));
+#endif
+
+#ifdef AVA_PARSE_STATS
+    memset(&last_parse_stats, 0, sizeof(last_parse_stats));
+#endif
 }
 
 // DO NOT TRY TO INIT THIS. This can only be written via an system call.
@@ -56,7 +87,3 @@ nvram_data const N_data_real;
 #else
 nvram_data N_data_real;
 #endif
-
-#if !defined(TARGET_NANOX) && !defined(TARGET_NANOS2)
-_Static_assert(sizeof(global) <= 2120, "Size of globals_t exceeds the tested working limit");
-#endif
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "bolos_target.h"
+#include "key_precompute.h"
 #include "parser.h"
+#include "pubkey_cache.h"
 #include "evm_parse.h"
+#include "sign_session.h"
 #include "types.h"
 
 // Zeros out all globals that can keep track of APDU instruction state.
@@ -29,7 +32,6 @@ typedef struct {
     struct {
         struct TransactionState state;
         parser_meta_state_t meta_state;
-        bool is_last_message;
     } parser;
 } apdu_sign_state_t;
 
@@ -44,6 +46,43 @@ typedef struct {
     };
 } apdu_evm_sign_state_t;
 
+// Bytes of an EIP-191 personal message kept for its prompt
+#define EVM_MESSAGE_PREVIEW_SIZE 64
+
+typedef struct {
+    bip32_path_t bip32_path;
+    sign_hash_t final_hash;
+    cx_sha3_t hash_state;
+    uint32_t length;
+    uint32_t remaining; // Message bytes not received yet
+    bool is_text; // Every byte so far is printable ASCII or a newline
+    uint8_t preview_length;
+    uint8_t preview[EVM_MESSAGE_PREVIEW_SIZE];
+} apdu_evm_personal_sign_state_t;
+
+// EIP712Domain members, as bits of the mask sent with a streamed domain
+#define EIP712_DOMAIN_NAME               0x01
+#define EIP712_DOMAIN_VERSION            0x02
+#define EIP712_DOMAIN_CHAIN_ID           0x04
+#define EIP712_DOMAIN_VERIFYING_CONTRACT 0x08
+#define EIP712_DOMAIN_SALT               0x10
+#define EIP712_DOMAIN_MEMBERS            5
+#define EIP712_DOMAIN_NAME_MAX_LENGTH    32
+
+typedef struct {
+    bip32_path_t bip32_path;
+    sign_hash_t final_hash;
+    sign_hash_t domain_separator;
+    sign_hash_t message_hash;
+    cx_sha3_t hash_state; // Used for one digest at a time
+    uint32_t message_length; // Bytes of the streamed message's encoding received so far
+    bool awaiting_message;
+    uint8_t domain_fields; // EIP712_DOMAIN_* bits; 0 when the hashes were given directly
+    uint8_t chain_id[32];
+    uint8_t verifying_contract[20];
+    char name[EIP712_DOMAIN_NAME_MAX_LENGTH + 1];
+} apdu_evm_eip712_state_t;
+
 enum pubkey_state_type {
     PUBKEY_STATE_AVM,
     PUBKEY_STATE_EVM
@@ -58,6 +97,15 @@ typedef struct {
     enum pubkey_state_type type;
 } apdu_pubkey_state_t;
 
+#ifdef STACK_MEASURE
+#define STACK_STATS_INSTRUCTIONS 14 // Covers every AVM and EVM instruction
+
+typedef struct {
+    uint16_t last; // Bytes of stack used by the most recent call
+    uint16_t max;
+} stack_stats_t;
+#endif
+
 typedef struct {
     void *stack_root;
 
@@ -86,16 +134,31 @@ typedef struct {
     } ui;
 
     struct {
+        sign_session_t session; // Shared by the streaming signing flows in u
         union {
             apdu_pubkey_state_t pubkey;
             apdu_sign_state_t sign;
             apdu_evm_sign_state_t evm_sign;
+            apdu_evm_personal_sign_state_t evm_personal_sign;
+            apdu_evm_eip712_state_t evm_eip712;
         } u;
     } apdu;
 
     uint8_t latest_apdu_instruction; // For detecting when a sequence of requests to the same APDU ends
     uint8_t latest_apdu_cla; // For detecting when a sequence of requests to the same APDU ends
     nvram_data new_data;
+    bool pubkey_cache_checked; // Seed fingerprint of the public key cache checked this launch
+    uint8_t pubkey_cache_writes; // Public key cache entries written this launch
+    pubkey_lru_t pubkey_lru; // Survives clear_apdu_globals
+#ifdef HAVE_KEY_PRECOMPUTE
+    precomputed_node_t precomputed_node; // Secret; cleared with the signing session
+#endif
+    erc20_cache_t erc20_cache; // Survives clear_apdu_globals
+
+#ifdef STACK_MEASURE
+    // Stack use per instruction, AVM then EVM; survives clear_apdu_globals
+    stack_stats_t stack_stats[2][STACK_STATS_INSTRUCTIONS];
+#endif
 } globals_t;
 
 extern globals_t global;
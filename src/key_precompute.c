@@ -0,0 +1,159 @@
+#include "key_precompute.h"
+
+#include "globals.h"
+#include "keys.h"
+#include "key_macros.h"
+
+#include <string.h>
+
+#ifdef HAVE_KEY_PRECOMPUTE
+#define P global.precomputed_node
+
+// Order of the secp256k1 group
+static uint8_t const secp256k1_n[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xfe,
+    0xba, 0xae, 0xdc, 0xe6, 0xaf, 0x48, 0xa0, 0x3b, 0xbf, 0xd2, 0x5e, 0x8c, 0xd0, 0x36, 0x41, 0x41,
+};
+
+static void compress_public_key(uint8_t *const out, cx_ecfp_public_key_t const *const key) {
+    out[0] = 0x02 + (key->W[64] & 0x01);
+    memcpy(&out[1], &key->W[1], BIP32_COMPRESSED_PUBKEY_SIZE - 1);
+}
+
+void precompute_key_request(bip32_path_t const *const path) {
+    check_null(path);
+    precompute_key_clear();
+    memcpy(&P.path, path, sizeof(P.path));
+}
+
+void precompute_key_arm(void) {
+    P.armed = P.path.length != 0;
+}
+
+void precompute_key_clear(void) {
+    explicit_bzero(&P, sizeof(P));
+}
+
+static void derive_requested_node(void) {
+    WITH_EXTENDED_KEY_PAIR(P.path, it, void*, ({
+        memcpy(P.node.private_key, it->key_pair.private_key.d, sizeof(P.node.private_key));
+        memcpy(P.node.chain_code, it->chain_code, sizeof(P.node.chain_code));
+        compress_public_key(P.node.public_key, &it->key_pair.public_key);
+        NULL;
+    }));
+}
+
+void precompute_key_tick(void) {
+    if (!P.armed || P.ready) return;
+    P.armed = false; // One attempt per request
+
+    BEGIN_TRY {
+        TRY {
+            derive_requested_node();
+            P.ready = true;
+        }
+        CATCH_OTHER(e) {
+            // Speculation must never disturb the UI; signing falls back to deriving from the seed.
+            PRINTF("Key precomputation failed: %x\n", e);
+            precompute_key_clear();
+        }
+        FINALLY {}
+    }
+    END_TRY;
+}
+
+// BIP32 CKDpriv for a non-hardened index. Returns false for the (negligibly
+// likely) indices BIP32 says are invalid, leaving the caller to fall back.
+// The child's public key is only computed when more steps follow.
+static bool derive_child(bip32_node_t *const node, uint32_t const index, bool const need_public_key) {
+    uint8_t data[BIP32_COMPRESSED_PUBKEY_SIZE + sizeof(uint32_t)];
+    uint8_t digest[64];
+    memcpy(data, node->public_key, BIP32_COMPRESSED_PUBKEY_SIZE);
+    data[BIP32_COMPRESSED_PUBKEY_SIZE + 0] = (uint8_t)(index >> 24);
+    data[BIP32_COMPRESSED_PUBKEY_SIZE + 1] = (uint8_t)(index >> 16);
+    data[BIP32_COMPRESSED_PUBKEY_SIZE + 2] = (uint8_t)(index >> 8);
+    data[BIP32_COMPRESSED_PUBKEY_SIZE + 3] = (uint8_t)index;
+
+    cx_hmac_sha512_t hmac_state;
+    cx_hmac_sha512_init(&hmac_state, node->chain_code, sizeof(node->chain_code));
+    cx_hmac((cx_hmac_t *)&hmac_state, CX_LAST, data, sizeof(data), digest, sizeof(digest));
+
+    bool ok = cx_math_cmp(digest, secp256k1_n, 32) < 0;
+    if (ok) {
+        uint8_t child_key[32];
+        cx_math_addm(child_key, node->private_key, digest, secp256k1_n, sizeof(child_key));
+        memcpy(node->private_key, child_key, sizeof(node->private_key));
+        explicit_bzero(child_key, sizeof(child_key));
+        ok = !cx_math_is_zero(node->private_key, sizeof(node->private_key));
+    }
+    memcpy(node->chain_code, &digest[32], sizeof(node->chain_code));
+    explicit_bzero(digest, sizeof(digest));
+    explicit_bzero(&hmac_state, sizeof(hmac_state));
+
+    if (ok && need_public_key) {
+        key_pair_t pair;
+        cx_ecfp_init_private_key(CX_CURVE_SECP256K1, node->private_key, sizeof(node->private_key), &pair.private_key);
+        cx_ecfp_generate_pair(CX_CURVE_SECP256K1, &pair.public_key, &pair.private_key, 1);
+        compress_public_key(node->public_key, &pair.public_key);
+        explicit_bzero(&pair, sizeof(pair));
+    }
+    return ok;
+}
+
+// Fills node with the key at path when it can be reached from the precomputed node.
+static bool derive_from_precomputed(bip32_node_t *const node, bip32_path_t const *const path) {
+    if (!P.ready || path->length < P.path.length) return false;
+    for (size_t i = 0; i < path->length; i++) {
+        if (i < P.path.length ? path->components[i] != P.path.components[i]
+                              : (path->components[i] & BIP32_HARDENED_PATH_BIT) != 0) {
+            return false;
+        }
+    }
+
+    memcpy(node, &P.node, sizeof(*node));
+    for (size_t i = P.path.length; i < path->length; i++) {
+        if (!derive_child(node, path->components[i], i + 1 < path->length)) return false;
+    }
+    return true;
+}
+#endif
+
+static size_t sign_from_seed(uint8_t *const out, size_t const out_size, bip32_path_t const *const path,
+                             uint8_t const *const in, size_t const in_size) {
+    return WITH_EXTENDED_KEY_PAIR(*path, it, size_t, ({
+        sign(out, out_size, &it->key_pair, in, in_size);
+    }));
+}
+
+size_t sign_with_path(uint8_t *const out, size_t const out_size, bip32_path_t const *const path,
+                      uint8_t const *const in, size_t const in_size) {
+    check_null(path);
+#ifndef HAVE_KEY_PRECOMPUTE
+    return sign_from_seed(out, out_size, path, in, in_size);
+#else
+    bip32_node_t volatile node;
+    key_pair_t volatile pair;
+    size_t volatile tx = 0;
+    BEGIN_TRY {
+        TRY {
+            if (derive_from_precomputed((bip32_node_t *)&node, path)) {
+                PRINTF("Signing from precomputed node\n");
+                cx_ecfp_init_private_key(CX_CURVE_SECP256K1, (uint8_t const *)node.private_key,
+                                         sizeof(node.private_key), (cx_ecfp_private_key_t *)&pair.private_key);
+                tx = sign(out, out_size, (key_pair_t const *)&pair, in, in_size);
+            } else {
+                tx = sign_from_seed(out, out_size, path, in, in_size);
+            }
+        }
+        CATCH_OTHER(e) {
+            THROW(e);
+        }
+        FINALLY {
+            explicit_bzero((bip32_node_t *)&node, sizeof(node));
+            explicit_bzero((key_pair_t *)&pair, sizeof(pair));
+        }
+    }
+    END_TRY;
+    return tx;
+#endif
+}
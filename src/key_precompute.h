@@ -0,0 +1,52 @@
+#pragma once
+
+#include "bolos_target.h"
+#include "types.h"
+
+// Speculative key derivation. Once a signing request has named its path, the
+// BIP32 node for that path is derived on ticker events while the user reviews
+// prompts, so that after approval only the last non-hardened steps and the
+// ECDSA signature remain. Nano S has no RAM to spare for the node, so there
+// the hooks below do nothing and signing always derives from the seed.
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define HAVE_KEY_PRECOMPUTE
+#endif
+
+#define BIP32_COMPRESSED_PUBKEY_SIZE 33
+
+typedef struct {
+    uint8_t private_key[32];
+    uint8_t chain_code[CHAIN_CODE_DATA_SIZE];
+    uint8_t public_key[BIP32_COMPRESSED_PUBKEY_SIZE]; // Compressed; needed for non-hardened children
+} bip32_node_t;
+
+typedef struct {
+    bip32_path_t path; // length 0 when nothing has been requested
+    bool armed; // A prompt is up, so ticker time may be spent deriving
+    bool ready;
+    bip32_node_t node;
+} precomputed_node_t;
+
+#ifdef HAVE_KEY_PRECOMPUTE
+// Names the path later signatures will be derived under, dropping any earlier node.
+void precompute_key_request(bip32_path_t const *const path);
+
+// Called when the UI starts waiting on the user.
+void precompute_key_arm(void);
+
+// Called on every ticker event; derives the requested node once armed.
+void precompute_key_tick(void);
+
+// Zeroizes the node. Call on reject and whenever the signing session ends.
+void precompute_key_clear(void);
+#else
+static inline void precompute_key_request(bip32_path_t const *const path) { (void)path; }
+static inline void precompute_key_arm(void) {}
+static inline void precompute_key_tick(void) {}
+static inline void precompute_key_clear(void) {}
+#endif
+
+// Signs `in` with the key at path. Starts from the precomputed node when path
+// extends it by non-hardened steps only; derives from the seed otherwise.
+size_t sign_with_path(uint8_t *const out, size_t const out_size, bip32_path_t const *const path,
+                      uint8_t const *const in, size_t const in_size);
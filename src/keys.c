@@ -20,6 +20,7 @@
 #include "apdu.h"
 #include "globals.h"
 #include "memory.h"
+#include "profile.h"
 #include "protocol.h"
 #include "types.h"
 
@@ -128,6 +129,32 @@ void generate_extended_key_pair(extended_key_pair_t *const out, bip32_path_t con
                     out->key_pair.public_key.W_len);
                 out->key_pair.public_key.W_len = 33;
             }
+            PROFILE_COUNT(PROFILE_DERIVE);
+        }
+        CATCH_OTHER(e) {
+            THROW(e);
+        }
+        FINALLY {
+            explicit_bzero((unsigned char /*volatile*/*const)private_key_data, sizeof(private_key_data));
+        }
+    }
+    END_TRY;
+}
+
+void generate_chain_code(uint8_t *const out, bip32_path_t const *const bip32_path) {
+    check_null(out);
+    check_null(bip32_path);
+
+    unsigned char volatile private_key_data[PRIVATE_KEY_DATA_SIZE];
+    explicit_bzero((unsigned char /*volatile*/*const)&private_key_data, sizeof(private_key_data));
+
+    BEGIN_TRY {
+        TRY {
+            os_perso_derive_node_bip32(
+                CX_CURVE_SECP256K1,
+                bip32_path->components, bip32_path->length,
+                (unsigned char /*volatile*/*const)private_key_data,
+                out);
         }
         CATCH_OTHER(e) {
             THROW(e);
@@ -160,6 +187,7 @@ size_t sign(uint8_t *const out, size_t const out_size, key_pair_t const *const p
     cx_ecdsa_sign(&pair->private_key, CX_LAST | CX_RND_RFC6979,
                   CX_SHA256, // historical reasons...semantically CX_NONE
                   (uint8_t const *const)PIC(in), in_size, sig, SIG_SIZE, &info);
+    PROFILE_COUNT(PROFILE_SIGN);
 
     // Converting to compressed format
     int const r_size = sig[3];
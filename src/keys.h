@@ -30,6 +30,10 @@ void concat_bip32_path(bip32_path_t *const out, bip32_path_t const *const in);
 
 void generate_extended_key_pair(extended_key_pair_t *const out, bip32_path_t const *const bip32_path);
 
+// Writes the CHAIN_CODE_DATA_SIZE byte chain code at bip32_path to out. Unlike
+// generate_extended_key_pair it skips the public key's point multiplication.
+void generate_chain_code(uint8_t *const out, bip32_path_t const *const bip32_path);
+
 // Non-reentrant
 cx_ecfp_public_key_t const *public_key_hash_return_global(uint8_t *const out, size_t const out_size,
                                                           cx_ecfp_public_key_t const *const restrict public_key);
@@ -8,12 +8,28 @@ static const apdu_handler avm_handlers[] = {
     handle_apdu_get_public_key_ext,  // 0x03
     handle_apdu_sign_hash,           // 0x04
     handle_apdu_sign_transaction,    // 0x05
+    handle_apdu_preview_transaction, // 0x06
+#ifdef STACK_MEASURE
+    handle_apdu_diagnostics,         // 0x07
+#endif
+#ifdef AVA_PROFILE
+    [0x08] = handle_apdu_profile,
+#endif
+#ifdef AVA_TRACE
+    [0x09] = handle_apdu_trace_drain,
+#endif
+#ifdef AVA_PARSE_STATS
+    [0x0a] = handle_apdu_parse_stats,
+#endif
 };
 
 static const apdu_handler evm_handlers[] = {
     [2] = (apdu_handler)handle_apdu_evm_get_address,
     [4] = (apdu_handler)handle_apdu_sign_evm_transaction,
-    [0x0a] = (apdu_handler)handle_apdu_provide_erc20
+    [8] = (apdu_handler)handle_apdu_sign_evm_personal_message,
+    [0x0a] = (apdu_handler)handle_apdu_provide_erc20,
+    [0x0c] = (apdu_handler)handle_apdu_sign_evm_eip712_hashed,
+    [0x0d] = (apdu_handler)handle_apdu_sign_evm_eip712_streamed
 };
 
 static const struct app_handlers g_handlers = {
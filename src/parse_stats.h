@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Opt-in streaming statistics (PARSE_STATS=1) for tuning chunk and prompt
+// batch sizes. Each flow's parser meta state counts the current session; the
+// last session to finish is kept for the parse stats instruction.
+
+#ifdef AVA_PARSE_STATS
+
+typedef struct {
+    uint16_t chunks;         // Transaction APDUs fed to the parser
+    uint16_t min_chunk;      // Smallest and largest of those, in bytes
+    uint16_t max_chunk;
+    uint32_t bytes;
+    uint16_t prompt_flushes; // PROMPT returns: a batch of prompts filled up
+    uint16_t need_more;      // NEED_MORE returns: a chunk ran out mid-transaction
+    uint16_t resumes;        // Re-entries after the user accepted a batch
+} parse_stats_t;
+
+extern parse_stats_t last_parse_stats;
+
+static inline void parse_stats_chunk(parse_stats_t *const stats, size_t const length) {
+    if (stats->chunks == 0 || length < stats->min_chunk) stats->min_chunk = length;
+    if (length > stats->max_chunk) stats->max_chunk = length;
+    stats->chunks++;
+    stats->bytes += length;
+}
+
+#define PARSE_STATS_RV(stats, rv) ({ \
+        if ((rv) == PARSE_RV_PROMPT) (stats).prompt_flushes++; \
+        else if ((rv) == PARSE_RV_NEED_MORE) (stats).need_more++; \
+    })
+
+#else
+
+#define PARSE_STATS_RV(stats, rv)
+
+#endif
@@ -11,6 +11,14 @@ void initFixed(struct FixedState *const state, size_t const len);
 
 enum parse_rv parseFixed(struct FixedState *const state, parser_input_meta_state_t *const input, size_t const len);
 
+enum parse_rv parseFixedInPlace(struct FixedState *const state, parser_input_meta_state_t *const input, size_t const len, uint8_t const **const out);
+
+// For states that are always filled completely before being read; initFixed
+// also clears the buffer for parsers that read short fields into it.
+static inline void resetFixed(struct FixedState *const state) {
+    state->filledTo = 0;
+}
+
 enum parse_rv skipBytes(struct FixedState *const state, parser_input_meta_state_t *const input, size_t const len);
 
 ////
@@ -46,7 +54,7 @@ static inline struct FixedState * fixed_state_con(struct FixedState0 * p) {
     } \
     \
     static inline void init_ ## name (struct name ## _state *const state) { \
-        return initFixed(fs(state), sizeof(*state)); \
+        resetFixed(fs(state)); \
     } \
     \
     ASSERT_FIXED(name)
@@ -54,49 +62,21 @@ static inline struct FixedState * fixed_state_con(struct FixedState0 * p) {
 #define IMPL_FIXED_BE(name) \
     static inline enum parse_rv parse_ ## name (struct name ## _state *const state, parser_meta_state_t *const meta) { \
         enum parse_rv sub_rv = PARSE_RV_INVALID; \
-        sub_rv = parseFixed(fs(state), &meta->input, sizeof(name)); \
+        uint8_t const *field; \
+        sub_rv = parseFixedInPlace(fs(state), &meta->input, sizeof(name), &field); \
         if (sub_rv == PARSE_RV_DONE) { \
-            state->val = READ_UNALIGNED_BIG_ENDIAN(name, state->buf); \
+            state->val = READ_UNALIGNED_BIG_ENDIAN(name, field); \
         } \
         return sub_rv; \
     } \
     static inline void init_ ## name (struct name ## _state *const state) { \
-        return initFixed(fs(state), sizeof(*state)); \
+        resetFixed(fs(state)); \
     }\
     \
     ASSERT_FIXED(name)
 
 IMPL_FIXED(uint8_t);
 
-#define IMPL_ARRAY(name) \
-    void init_ ## name ## s (struct name ## s_state *const state) { \
-        state->state = 0; \
-        state->i = 0; \
-        init_uint32_t(&state->len_state); \
-    } \
-    enum parse_rv parse_ ## name ## s (struct name ## s_state *const state, parser_meta_state_t *const meta) { \
-        enum parse_rv sub_rv = PARSE_RV_INVALID; \
-        switch (state->state) { \
-            case 0: \
-                CALL_SUBPARSER(len_state, uint32_t); \
-                state->len = READ_UNALIGNED_BIG_ENDIAN(uint32_t, state->len_state.buf); \
-                state->state++; \
-                if(state->len == 0) break; \
-                init_ ## name(&state->item); \
-                fallthrough; /* NOTE! */ \
-            case 1: \
-                while (true) { \
-                    PRINTF(#name " %d\n", state->i + 1); \
-                    CALL_SUBPARSER(item, name); \
-                    state->i++; \
-                    if (state->i == state->len) return PARSE_RV_DONE; \
-                    init_ ## name(&state->item); \
-                } \
-                break; \
-        } \
-        return sub_rv; \
-    }
-
 #define RET_IF_NOT_DONE \
     if (sub_rv != PARSE_RV_DONE) return sub_rv
 
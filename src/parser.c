@@ -1,11 +1,13 @@
 #include "exception.h"
 #include "globals.h"
 #include "parser-impl.h"
+#include "codec_schema.h"
 #include "protocol.h"
 #include "to_string.h"
 #include "types.h"
 #include "network_info.h"
 #include "hash.h"
+#include "trace.h"
 
 bool should_flush(const prompt_batch_t *const prompt) {
   bool test = prompt->count > prompt->flushIndex;
@@ -45,6 +47,16 @@ void set_next_batch_size(prompt_batch_t *const prompt, size_t size) {
 #define INIT_SUBPARSER_WITH(subFieldName, subParser, ...) \
     init_ ## subParser(&state->subFieldName, __VA_ARGS__);
 
+// Transaction sections and their elements share the TransactionState, each
+// working one level further down its stack of steps.
+#define CALL_LEVEL(subParser) { \
+        sub_rv = parse_ ## subParser(state, meta); \
+        RET_IF_NOT_DONE; \
+    }
+
+#define INIT_LEVEL(subParser) \
+    init_ ## subParser(state);
+
 static bool is_pchain(blockchain_id_t *blockchain_id);
 
 static void check_asset_id(Id32 const *const asset_id, parser_meta_state_t *const meta) {
@@ -145,6 +157,21 @@ enum parse_rv parseFixed(struct FixedState *const state, parser_input_meta_state
     return state->filledTo == len ? PARSE_RV_DONE : PARSE_RV_NEED_MORE;
 }
 
+// Like parseFixed, but when the whole field is in the current chunk and none
+// of it was buffered yet, *out points straight into the input instead of the
+// field being copied. Otherwise it falls back to the copying accumulator and
+// *out points at state->buffer once that is full. Either way *out is only
+// valid until this parse call returns.
+enum parse_rv parseFixedInPlace(struct FixedState *const state, parser_input_meta_state_t *const input, size_t const len, uint8_t const **const out) {
+    if (state->filledTo == 0 && input->length - input->consumed >= len) {
+        *out = &input->src[input->consumed];
+        input->consumed += len;
+        return PARSE_RV_DONE;
+    }
+    *out = state->buffer;
+    return parseFixed(state, input, len);
+}
+
 enum parse_rv skipBytes(struct FixedState *const state, parser_input_meta_state_t *const input, size_t const len) {
   size_t const available = input->length - input->consumed;
   size_t const needed = len - state->filledTo;
@@ -161,13 +188,6 @@ IMPL_FIXED(Id32);
 IMPL_FIXED(blockchain_id_t);
 IMPL_FIXED(Address);
 
-void init_SECP256K1TransferOutput(struct SECP256K1TransferOutput_state *const state) {
-    state->state = 0;
-    state->address_n = 0;
-    state->address_i = 0;
-    INIT_SUBPARSER(uint64State, uint64_t);
-}
-
 static void output_prompt_to_string(char *const out, size_t const out_size, output_prompt_t const *const in) {
     network_info_t const *const network_info = network_info_from_network_id(in->network_id);
     if (network_info == NULL) REJECT("Can't determine network HRP for addresses");
@@ -210,348 +230,6 @@ static void gendata_to_hex(char *const out, size_t const out_size, gendata_promp
     bin_to_hex(&out[ix], out_size - ix, in->buffer, sizeof(in->buffer));
 }
 
-enum parse_rv parse_SECP256K1TransferOutput(struct SECP256K1TransferOutput_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-        case 0: {
-            // Amount; Type is already handled in init_Output
-            CALL_SUBPARSER(uint64State, uint64_t);
-            PRINTF("OUTPUT AMOUNT: %.*h\n", sizeof(state->uint64State.buf), state->uint64State.buf); // we don't seem to have longs in printf specfiers.
-            if (__builtin_uaddll_overflow(state->uint64State.val, meta->sum_of_outputs, &meta->sum_of_outputs)) THROW_(EXC_MEMORY_ERROR, "Sum of outputs overflowed");
-            meta->last_output_amount = state->uint64State.val;
-            state->state++;
-            INIT_SUBPARSER(uint64State, uint64_t);
-        } fallthrough;
-        case 1:
-            // Locktime
-            CALL_SUBPARSER(uint64State, uint64_t);
-            PRINTF("LOCK TIME: %.*h\n", sizeof(state->uint64State.buf), state->uint64State.buf); // we don't seem to have longs in printf specfiers.
-            state->state++;
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 2:
-            // Threshold
-            CALL_SUBPARSER(uint32State, uint32_t);
-            PRINTF("Threshold: %d\n", state->uint32State.val);
-            state->state++;
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 3: // Address Count
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->state++;
-            state->address_n = state->uint32State.val;
-            if (state->address_n != 1) REJECT("Multi-address outputs are not supported");
-            INIT_SUBPARSER(addressState, Address);
-            fallthrough;
-        case 4: {
-            if (state->address_i == state->address_n) {
-                state->state++;
-                break;
-            }
-            do {
-                // loop invariant
-                if (state->address_i == state->address_n) {
-                   THROW(EXC_MEMORY_ERROR);
-                }
-
-                CALL_SUBPARSER(addressState, Address);
-                PRINTF("Output address %d: %.*h\n",
-                    state->address_i + 1,
-                    sizeof(state->addressState.buf), state->addressState.buf);
-
-                output_prompt_t output_prompt;
-                memset(&output_prompt, 0, sizeof(output_prompt));
-                if (!(meta->last_output_amount > 0)) REJECT("Assertion failed: last_output_amount > 0");
-                output_prompt.amount = meta->last_output_amount;
-                output_prompt.network_id = meta->network_id;
-                memcpy(&output_prompt.address, &state->addressState.val, sizeof(output_prompt.address));
-                // TODO: We can get rid of this if we add back the P/X- in front of an address
-                if (memcmp(state->addressState.buf, global.apdu.u.sign.change_address, sizeof(public_key_hash_t)) == 0) {
-                  // skip change address
-                } else if(meta->swap_output) {
-                  switch (meta->chain) {
-                  case CHAIN_X:
-                    switch (meta->type_id.x) {
-                    case TRANSACTION_X_CHAIN_TYPE_ID_EXPORT:
-                        if (meta->swapCounterpartChain == CHAIN_P) {
-                            ADD_PROMPT("X to P chain", &output_prompt, sizeof(output_prompt), output_prompt_to_string)
-                        } else {
-                            ADD_PROMPT("X to C chain", &output_prompt, sizeof(output_prompt), output_prompt_to_string);
-                        }
-                        break;
-                    default:
-                        // If we throw here, we set swap_output somewhere _wrong_.
-                        THROW(EXC_PARSE_ERROR);
-                    };
-                    break;
-                  case CHAIN_P:
-                    switch (meta->type_id.p) {
-                    case TRANSACTION_P_CHAIN_TYPE_ID_EXPORT:
-                        ADD_PROMPT(
-                            "P chain export",
-                            &output_prompt, sizeof(output_prompt),
-                            output_prompt_to_string
-                            );
-                        break;
-                    case TRANSACTION_P_CHAIN_TYPE_ID_ADD_VALIDATOR:
-                    case TRANSACTION_P_CHAIN_TYPE_ID_ADD_DELEGATOR:
-
-                        if (__builtin_uaddll_overflow(meta->staked, meta->last_output_amount, &meta->staked)) THROW_(EXC_MEMORY_ERROR, "Stake total overflowed.");
-                        ADD_PROMPT(
-                            "Stake",
-                            &output_prompt, sizeof(output_prompt),
-                            output_prompt_to_string
-                            );
-                        break;
-                    default:
-                        // If we throw here, we set swap_output somewhere _wrong_.
-                        THROW(EXC_PARSE_ERROR);
-                    };
-                    break;
-                  case CHAIN_C:
-                    // If we throw here, we set swap_output somewhere _wrong_.
-                    THROW(EXC_PARSE_ERROR);
-                  }
-                } else {
-                  switch (meta->chain) {
-                  case CHAIN_X:
-                    switch (meta->type_id.x) {
-                    case TRANSACTION_X_CHAIN_TYPE_ID_IMPORT:
-                      ADD_PROMPT(
-                          "Sending",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                      break;
-                    default:
-                      ADD_PROMPT(
-                          "Transfer",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                    }
-                    break;
-                  case CHAIN_P:
-                    switch (meta->type_id.p) {
-                    case TRANSACTION_P_CHAIN_TYPE_ID_IMPORT:
-                      ADD_PROMPT(
-                          "P chain import",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                      break;
-                    case TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR:
-                      PRINTF("This transaction does not conduct a transfer of funds\n");
-                      break;
-                    case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_CHAIN:
-                      PRINTF("This transaction does not conduct a transfer of funds\n");
-                      break;
-                    case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET:
-                      PRINTF("This transaction does not conduct a transfer of funds\n");
-                      break;
-                    default:
-                      ADD_PROMPT(
-                          "Transfer",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                    }
-                    break;
-                  case CHAIN_C:
-                    switch (meta->type_id.c) {
-                    case TRANSACTION_C_CHAIN_TYPE_ID_EXPORT:
-                      ADD_PROMPT(
-                          "C chain export",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                      break;
-                    default:
-                      ADD_PROMPT(
-                          "Transfer",
-                          &output_prompt, sizeof(output_prompt),
-                          output_prompt_to_string
-                          );
-                    }
-                    break;
-                  }
-                }
-
-                state->address_i++;
-                if (state->address_i < state->address_n) {
-                    INIT_SUBPARSER(addressState, Address);
-                    RET_IF_PROMPT_FLUSH;
-                    continue;
-                } else {
-                    state->state++;
-                    RET_IF_PROMPT_FLUSH;
-                    break;
-                }
-            } while (false);
-        }
-        fallthrough; // NOTE
-        case 5:
-            sub_rv = PARSE_RV_DONE;
-            break;
-    }
-    return sub_rv;
-}
-
-void init_SECP256K1OutputOwners(struct SECP256K1OutputOwners_state *const state) {
-  state->state=0;
-  state->address_i=0;
-  INIT_SUBPARSER(uint32State, uint32_t);
-}
-
-enum parse_rv parse_SECP256K1OutputOwners(struct SECP256K1OutputOwners_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-        case 0: {
-            // Type ID
-            CALL_SUBPARSER(uint32State, uint32_t);
-            PRINTF("OUPTUT OWNERS\n");
-            state->state++;
-            INIT_SUBPARSER(uint64State, uint64_t);
-        } fallthrough;
-        case 1:
-            // Locktime
-            CALL_SUBPARSER(uint64State, uint64_t);
-            PRINTF("LOCK TIME: %.*h\n", sizeof(state->uint64State.buf), state->uint64State.buf); // we don't seem to have longs in printf specfiers.
-            state->state++;
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 2:
-            // Threshold
-            CALL_SUBPARSER(uint32State, uint32_t);
-            PRINTF("Threshold: %d\n", state->uint32State.val);
-            if(meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET)
-            {
-              ADD_PROMPT("Threshold", &state->uint32State.val, sizeof(state->uint32State.val), number_to_string_indirect32);
-            }
-            state->state++;
-            INIT_SUBPARSER(uint32State, uint32_t);
-            RET_IF_PROMPT_FLUSH;
-            fallthrough;
-        case 3: // Address Count
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->state++;
-            state->address_n = state->uint32State.val;
-            PRINTF("Addr Count\n");
-            if (state->address_n != 1) REJECT("Multi-address outputs are not supported");
-            INIT_SUBPARSER(addressState, Address);
-            fallthrough;
-        case 4: {
-            if (state->address_i == state->address_n) {
-                state->state++;
-                break;
-            }
-            do {
-                // loop invariant
-                if (state->address_i == state->address_n) {
-                   THROW(EXC_MEMORY_ERROR);
-                }
-
-                CALL_SUBPARSER(addressState, Address);
-
-                address_prompt_t address_prompt;
-                memset(&address_prompt, 0, sizeof(address_prompt));
-                address_prompt.network_id = meta->network_id;
-                memcpy(&address_prompt.address, &state->addressState.val, sizeof(address_prompt.address));
-                // TODO: We can get rid of this if we add back the P/X- in front of an address
-                if(meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET)
-                {
-                    ADD_PROMPT("Address", &address_prompt, sizeof(address_prompt_t), output_address_to_string);
-                }
-                else
-                {
-                    ADD_PROMPT("Rewards To", &address_prompt, sizeof(address_prompt_t), output_address_to_string);
-                }
-
-                state->address_i++;
-                if (state->address_i < state->address_n) {
-                    INIT_SUBPARSER(addressState, Address);
-                    RET_IF_PROMPT_FLUSH;
-                    continue;
-                } else {
-                    state->state++;
-                    RET_IF_PROMPT_FLUSH;
-                    break;
-                }
-            } while (false);
-        }
-        fallthrough;
-        case 5:
-            sub_rv = PARSE_RV_DONE;
-            break;
-    }
-    return sub_rv;
-}
-
-void init_SubnetAuth(struct SubnetAuth_state *const state)
-{
-  state->state = 0;
-  state->sigindices_i = 0;
-  INIT_SUBPARSER(uint32State, uint32_t);
-}
-
-enum parse_rv parse_SubnetAuth(struct SubnetAuth_state *const state, parser_meta_state_t *const meta) {
-  enum parse_rv sub_rv = PARSE_RV_INVALID;
-  switch(state->state)
-  {
-    case 0:
-      // Type ID
-      CALL_SUBPARSER(uint32State, uint32_t);
-      PRINTF("SUBNET AUTH\n");
-      state->state++;
-      INIT_SUBPARSER(uint32State, uint32_t);
-      fallthrough;
-    case 1: {
-      // Number of Sig Indices
-      CALL_SUBPARSER(uint32State, uint32_t);
-      state->state++;
-      state->sigindices_n = state->uint32State.val;
-      PRINTF("Sigind Count\n");
-      INIT_SUBPARSER(uint32State, uint32_t);
-    } fallthrough;
-    case 2: {
-      //
-      if (state->sigindices_i == state->sigindices_n)
-      {
-        state->state++;
-        break;
-      }
-      do
-      {
-        // loop invariant
-        if (state->sigindices_i == state->sigindices_n)
-        {
-          THROW(EXC_MEMORY_ERROR);
-        }
-
-        CALL_SUBPARSER(uint32State, uint32_t);
-
-        PRINTF("Address Index: %d\n", state->uint32State.val);
-
-        state->sigindices_i++;
-        if (state->sigindices_i < state->sigindices_n)
-        {
-          INIT_SUBPARSER(uint32State, uint32_t);
-          continue;
-        }
-        else
-        {
-          state->state++;
-          break;
-        }
-      } while(false);
-    } fallthrough;
-    case 3:
-      sub_rv = PARSE_RV_DONE;
-      break;
-  }
-  return sub_rv;
-}
-
 static void lockedFundsPrompt(char *const out, size_t const out_size, locked_prompt_t const *const in) {
     size_t ix = nano_avax_to_string(out, out_size, in->amount);
 
@@ -563,279 +241,418 @@ static void lockedFundsPrompt(char *const out, size_t const out_size, locked_pro
     time_to_string(&out[ix], out_size - ix, &in->until);
 }
 
-void init_StakeableLockOutput(struct StakeableLockOutput_state *const state) {
-    state->state=0;
-    INIT_SUBPARSER(uint64State, uint64_t);
+// Table-driven codec interpreter
+//
+// A schema (generated from codec_schema.h) is a static array of fields
+// terminated by CODEC_END. Integers are big-endian and decoded into
+// state->value; ID32 and ADDRESS are left for hooks to read through
+// state->bytes, which points into the input chunk unless the field straddled
+// two chunks and had to be gathered in state->fixed. An
+// ARRAY field reads a u32 count and repeats the field after it that many
+// times. STRUCT and VARIANT push the nested schema onto the state's stack,
+// VARIANT first picking it by a u32 type ID. SKIP reads a u32 length and
+// discards that many bytes.
+//
+// A field's hook runs once the field is complete (for STRUCT and VARIANT, once
+// the nested schema is), before the interpreter moves on. Hooks do the
+// accounting and queue prompts, returning PARSE_RV_PROMPT to flush them.
+
+static size_t codec_field_size(enum codec_field_kind const kind) {
+    switch (kind) {
+        case CODEC_U16: return sizeof(uint16_t);
+        case CODEC_U64: return sizeof(uint64_t);
+        case CODEC_ID32: return sizeof(Id32);
+        case CODEC_ADDRESS: return sizeof(Address);
+        case CODEC_U32:
+        case CODEC_ARRAY:
+        case CODEC_VARIANT:
+        case CODEC_SKIP: return sizeof(uint32_t);
+        default: THROW_(EXC_MEMORY_ERROR, "Codec field has no wire size");
+    }
 }
 
-enum parse_rv parse_StakeableLockOutput(struct StakeableLockOutput_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-      case 0: // Locktime
-        CALL_SUBPARSER(uint64State, uint64_t);
-        state->locktime=state->uint64State.val;
-        PRINTF("StakeableLockOutput locktime: %.*h\n", 8, state->uint64State.buf);
-        state->state++;
-        INIT_SUBPARSER(uint32State, uint32_t);
-        fallthrough;
-      case 1: // Parse the type field of the nested output here, rather than dispatching through Output.
-        CALL_SUBPARSER(uint32State, uint32_t);
-        if(state->uint32State.val != 0x00000007) REJECT("Can only parse SECP256K1TransferableOutput nested in StakeableLockoutput");
-        state->state++;
-        INIT_SUBPARSER(secp256k1TransferOutput, SECP256K1TransferOutput);
-        fallthrough;
-      case 2: // nested TransferrableOutput
-        CALL_SUBPARSER(secp256k1TransferOutput, SECP256K1TransferOutput);
-        locked_prompt_t promptData;
-        promptData.amount=meta->last_output_amount;
-        promptData.until=state->locktime;
-        state->state++;
-        ADD_PROMPT("Funds locked", &promptData, sizeof(locked_prompt_t), lockedFundsPrompt)
-        RET_IF_PROMPT_FLUSH;
-        fallthrough;
-      case 3:
-        sub_rv=PARSE_RV_DONE;
-        break;
-    }
-    return sub_rv;
+static inline struct codec_frame *codec_top(struct codec_state *const state) {
+    return &state->stack[state->depth - 1];
 }
 
-void init_Output(struct Output_state *const state) {
-    state->state = 0;
-    INIT_SUBPARSER(uint32State, uint32_t);
+static inline uint8_t *codec_top_field(struct codec_state *const state) {
+    return &state->field[state->depth - 1];
 }
 
-enum parse_rv parse_Output(struct Output_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-        case 0:
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->type = state->uint32State.val;
-            PRINTF("Output Type: %d\n", state->type);
-            state->state++;
-            switch (state->type) {
-                default: REJECT("Unrecognized output type");
-                case 0x00000007:
-                    INIT_SUBPARSER(secp256k1TransferOutput, SECP256K1TransferOutput);
-                    break;
-                case 0x00000016:
-                    INIT_SUBPARSER(stakeableLockOutput, StakeableLockOutput);
-                    break;
-            }
-            fallthrough;
-        case 1:
-            switch (state->type) {
-                default: REJECT("Unrecognized output type");
-                case 0x00000007:
-                    PRINTF("SECP256K1TransferOutput\n");
-                    CALL_SUBPARSER(secp256k1TransferOutput, SECP256K1TransferOutput);
-                    break;
-                case 0x00000016:
-                    CALL_SUBPARSER(stakeableLockOutput, StakeableLockOutput);
-                    break;
-            }
-    }
-    return sub_rv;
+static void codec_push(struct codec_state *const state, struct codec_field const *const schema) {
+    if (state->depth >= CODEC_MAX_DEPTH) THROW_(EXC_MEMORY_ERROR, "Codec stack overflow");
+    struct codec_frame *const frame = &state->stack[state->depth];
+    memset(frame, 0, sizeof(*frame));
+    frame->schema = schema;
+    state->field[state->depth] = 0;
+    state->depth++;
 }
 
-void init_TransferableOutput(struct TransferableOutput_state *const state) {
-    state->state = 0;
-    INIT_SUBPARSER(id32State, Id32);
+void init_codec(struct codec_state *const state, struct codec_field const *const schema) {
+    memset(state, 0, sizeof(*state));
+    codec_push(state, schema);
 }
 
-enum parse_rv parse_TransferableOutput(struct TransferableOutput_state *const state, parser_meta_state_t *const meta) {
-    PRINTF("***Parse Transferable Output***\n");
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
+// Runs the hook of the top frame's current field and moves past it, looping
+// back over array elements until the count read by the preceding ARRAY is met.
+static enum parse_rv codec_field_done(struct codec_state *const state, parser_meta_state_t *const meta) {
+    struct codec_frame *const frame = codec_top(state);
+    uint8_t *const field_i = codec_top_field(state);
+    struct codec_field const *const fields = PIC(frame->schema);
+    struct codec_field const *const field = &fields[*field_i];
+    TRACE(TRACE_CODEC_FIELD, field->kind, meta->input.consumed);
 
-    switch (state->state) {
-        case 0: // asset ID
-            CALL_SUBPARSER(id32State, Id32);
-            PRINTF("Asset ID: %.*h\n", 32, state->id32State.buf);
-            check_asset_id(&state->id32State.val, meta);
-            state->state++;
-            INIT_SUBPARSER(outputState, Output);
-            fallthrough;
-        case 1:
-            CALL_SUBPARSER(outputState, Output);
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    if (field->hook) {
+        sub_rv = PIC(field->hook)(state, meta);
+    }
+
+    if (field->kind == CODEC_ARRAY) {
+        frame->array_i = 0;
+        frame->array_n = state->value;
+        *field_i += frame->array_n == 0 ? 2 : 1;
+    } else if (*field_i > 0 && fields[*field_i - 1].kind == CODEC_ARRAY && ++frame->array_i < frame->array_n) {
+        // Stay on the element field for the next item
+    } else {
+        (*field_i)++;
     }
     return sub_rv;
 }
 
-void init_SECP256K1TransferInput(struct SECP256K1TransferInput_state *const state) {
-    state->state = 0;
-    state->address_index_i = 0;
-    state->address_index_n = 0;
-    INIT_SUBPARSER(uint64State, uint64_t);
+static struct codec_field const *codec_find_variant(struct codec_variant const *variants, uint32_t const type_id) {
+    for (variants = PIC(variants); variants->schema != NULL; variants++) {
+        if (variants->type_id == type_id) return variants->schema;
+    }
+    REJECT("Unrecognized type ID %u", type_id);
 }
 
-enum parse_rv parse_SECP256K1TransferInput(struct SECP256K1TransferInput_state *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_codec(struct codec_state *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
+    while (state->depth > 0) {
+        struct codec_frame *const frame = codec_top(state);
+        struct codec_field const *const field = &((struct codec_field const *)PIC(frame->schema))[*codec_top_field(state)];
+
+        if (field->kind == CODEC_END) {
+            state->depth--;
+            if (state->depth == 0) break;
+            // The parent's STRUCT or VARIANT field is complete now
+            sub_rv = codec_field_done(state, meta);
+            RET_IF_PROMPT_FLUSH;
+            continue;
+        }
 
-    switch (state->state) {
-        case 0: // Amount
-            CALL_SUBPARSER(uint64State, uint64_t);
-            state->state++;
-            PRINTF("INPUT AMOUNT: %.*h\n", sizeof(uint64_t), state->uint64State.buf);
-            if (__builtin_uaddll_overflow(state->uint64State.val, meta->sum_of_inputs, &meta->sum_of_inputs)) THROW_(EXC_MEMORY_ERROR, "Sum of inputs overflowed");
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 1: // Number of address indices
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->address_index_n = state->uint32State.val;
-            state->state++;
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 2: // Address indices
-            while (true) {
-                CALL_SUBPARSER(uint32State, uint32_t);
-                state->address_index_i++;
-                PRINTF("Address Index %d: %d\n", state->address_index_i, state->uint32State.val);
-                if (state->address_index_i == state->address_index_n) {
-                    sub_rv = PARSE_RV_DONE;
-                    break;
-                }
-                INIT_SUBPARSER(addressState, Address);
-            }
-            break; // Forward the break up.
+        if (state->skipping) {
+            size_t const available = meta->input.length - meta->input.consumed;
+            size_t const to_skip = MIN(state->value, available);
+            PRINTF("Skipped bytes: %.*h\n", to_skip, &meta->input.src[meta->input.consumed]);
+            meta->input.consumed += to_skip;
+            state->value -= to_skip;
+            if (state->value != 0) return PARSE_RV_NEED_MORE;
+            state->skipping = false;
+            sub_rv = codec_field_done(state, meta);
+            RET_IF_PROMPT_FLUSH;
+            continue;
+        }
+
+        if (field->kind == CODEC_STRUCT) {
+            codec_push(state, field->sub);
+            continue;
+        }
+
+        size_t const size = codec_field_size(field->kind);
+        sub_rv = parseFixedInPlace((struct FixedState *)&state->fixed, &meta->input, size, &state->bytes);
+        RET_IF_NOT_DONE;
+        state->fixed.filledTo = 0;
+
+        switch (field->kind) {
+            case CODEC_U16:
+                state->value = READ_UNALIGNED_BIG_ENDIAN(uint16_t, state->bytes);
+                break;
+            case CODEC_U64:
+                state->value = READ_UNALIGNED_BIG_ENDIAN(uint64_t, state->bytes);
+                break;
+            case CODEC_ID32:
+            case CODEC_ADDRESS:
+                break;
+            default:
+                state->value = READ_UNALIGNED_BIG_ENDIAN(uint32_t, state->bytes);
+                break;
+        }
+
+        if (field->kind == CODEC_VARIANT) {
+            PRINTF("Variant type ID: %d\n", (uint32_t)state->value);
+            codec_push(state, codec_find_variant(field->sub, state->value));
+            continue;
+        }
+        if (field->kind == CODEC_SKIP) {
+            state->skipping = true;
+            continue;
+        }
+
+        sub_rv = codec_field_done(state, meta);
+        RET_IF_PROMPT_FLUSH;
     }
+    return PARSE_RV_DONE;
+}
+
+_Static_assert(
+    offsetof(struct codec_state, fixed.buf) - offsetof(struct codec_state, fixed) == offsetof(struct FixedState, buffer),
+    "codec fixed buffer does not line up with struct FixedState");
+
+// Codec hooks and schemas for the Avalanche structures
+
+static enum parse_rv check_asset_id_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    PRINTF("Asset ID: %.*h\n", sizeof(Id32), state->bytes);
+    check_asset_id((Id32 const *)state->bytes, meta);
+    return PARSE_RV_DONE;
+}
+
+static enum parse_rv single_address_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    (void)meta;
+    if (state->value != 1) REJECT("Multi-address outputs are not supported");
+    return PARSE_RV_DONE;
+}
+
+static enum parse_rv output_amount_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    PRINTF("OUTPUT AMOUNT: %.*h\n", sizeof(uint64_t), state->bytes);
+    if (__builtin_uaddll_overflow(state->value, meta->sum_of_outputs, &meta->sum_of_outputs)) THROW_(EXC_MEMORY_ERROR, "Sum of outputs overflowed");
+    meta->last_output_amount = state->value;
+    return PARSE_RV_DONE;
+}
+
+static enum parse_rv input_amount_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    PRINTF("INPUT AMOUNT: %.*h\n", sizeof(uint64_t), state->bytes);
+    if (__builtin_uaddll_overflow(state->value, meta->sum_of_inputs, &meta->sum_of_inputs)) THROW_(EXC_MEMORY_ERROR, "Sum of inputs overflowed");
+    return PARSE_RV_DONE;
+}
+
+static enum parse_rv transfer_output_address_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    Address const *const address = (Address const *)state->bytes;
+    PRINTF("Output address %d: %.*h\n", codec_top(state)->array_i + 1, sizeof(*address), address);
+
+    output_prompt_t output_prompt;
+    memset(&output_prompt, 0, sizeof(output_prompt));
+    if (!(meta->last_output_amount > 0)) REJECT("Assertion failed: last_output_amount > 0");
+    output_prompt.amount = meta->last_output_amount;
+    output_prompt.network_id = meta->network_id;
+    memcpy(&output_prompt.address, &*address, sizeof(output_prompt.address));
+    // TODO: We can get rid of this if we add back the P/X- in front of an address
+    if (memcmp(address->val, global.apdu.u.sign.change_address, sizeof(public_key_hash_t)) == 0) {
+      // skip change address
+    } else if(meta->swap_output) {
+      switch (meta->chain) {
+      case CHAIN_X:
+        switch (meta->type_id.x) {
+        case TRANSACTION_X_CHAIN_TYPE_ID_EXPORT:
+            if (meta->swapCounterpartChain == CHAIN_P) {
+                ADD_PROMPT("X to P chain", &output_prompt, sizeof(output_prompt), output_prompt_to_string)
+            } else {
+                ADD_PROMPT("X to C chain", &output_prompt, sizeof(output_prompt), output_prompt_to_string);
+            }
+            break;
+        default:
+            // If we throw here, we set swap_output somewhere _wrong_.
+            THROW(EXC_PARSE_ERROR);
+        };
+        break;
+      case CHAIN_P:
+        switch (meta->type_id.p) {
+        case TRANSACTION_P_CHAIN_TYPE_ID_EXPORT:
+            ADD_PROMPT(
+                "P chain export",
+                &output_prompt, sizeof(output_prompt),
+                output_prompt_to_string
+                );
+            break;
+        case TRANSACTION_P_CHAIN_TYPE_ID_ADD_VALIDATOR:
+        case TRANSACTION_P_CHAIN_TYPE_ID_ADD_DELEGATOR:
 
+            if (__builtin_uaddll_overflow(meta->staked, meta->last_output_amount, &meta->staked)) THROW_(EXC_MEMORY_ERROR, "Stake total overflowed.");
+            ADD_PROMPT(
+                "Stake",
+                &output_prompt, sizeof(output_prompt),
+                output_prompt_to_string
+                );
+            break;
+        default:
+            // If we throw here, we set swap_output somewhere _wrong_.
+            THROW(EXC_PARSE_ERROR);
+        };
+        break;
+      case CHAIN_C:
+        // If we throw here, we set swap_output somewhere _wrong_.
+        THROW(EXC_PARSE_ERROR);
+      }
+    } else {
+      switch (meta->chain) {
+      case CHAIN_X:
+        switch (meta->type_id.x) {
+        case TRANSACTION_X_CHAIN_TYPE_ID_IMPORT:
+          ADD_PROMPT(
+              "Sending",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+          break;
+        default:
+          ADD_PROMPT(
+              "Transfer",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+        }
+        break;
+      case CHAIN_P:
+        switch (meta->type_id.p) {
+        case TRANSACTION_P_CHAIN_TYPE_ID_IMPORT:
+          ADD_PROMPT(
+              "P chain import",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+          break;
+        case TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR:
+          PRINTF("This transaction does not conduct a transfer of funds\n");
+          break;
+        case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_CHAIN:
+          PRINTF("This transaction does not conduct a transfer of funds\n");
+          break;
+        case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET:
+          PRINTF("This transaction does not conduct a transfer of funds\n");
+          break;
+        default:
+          ADD_PROMPT(
+              "Transfer",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+        }
+        break;
+      case CHAIN_C:
+        switch (meta->type_id.c) {
+        case TRANSACTION_C_CHAIN_TYPE_ID_EXPORT:
+          ADD_PROMPT(
+              "C chain export",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+          break;
+        default:
+          ADD_PROMPT(
+              "Transfer",
+              &output_prompt, sizeof(output_prompt),
+              output_prompt_to_string
+              );
+        }
+        break;
+      }
+    }
     return sub_rv;
 }
 
-void init_StakeableLockInput(struct StakeableLockInput_state *const state){
-    state->state=0;
-    INIT_SUBPARSER(uint64State, uint64_t);
+static enum parse_rv locktime_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    (void)meta;
+    PRINTF("Locktime: %.*h\n", sizeof(uint64_t), state->bytes);
+    state->held.u64 = state->value;
+    return PARSE_RV_DONE;
 }
 
-enum parse_rv parse_StakeableLockInput(struct StakeableLockInput_state *const state, parser_meta_state_t *const meta){
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-      case 0: // Locktime
-        CALL_SUBPARSER(uint64State, uint64_t);
-        PRINTF("StakeableLockInput locktime: %.*h\n", 8, state->uint64State.buf);
-        state->state++;
-        INIT_SUBPARSER(uint32State, uint32_t);
-        fallthrough;
-      case 1: // Parse the type field of the nested input here, rather than dispatching through Output.
-        CALL_SUBPARSER(uint32State, uint32_t);
-        if(state->uint32State.val != 0x00000005) REJECT("Can only parse SECP256K1TransferableInput nested in StakeableLockInput");
-        state->state++;
-        INIT_SUBPARSER(secp256k1TransferInput, SECP256K1TransferInput);
-        fallthrough;
-      case 2: // nested Input
-        CALL_SUBPARSER(secp256k1TransferInput, SECP256K1TransferInput);
-    }
+static enum parse_rv locked_funds_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    locked_prompt_t promptData;
+    promptData.amount = meta->last_output_amount;
+    promptData.until = state->held.u64;
+    ADD_PROMPT("Funds locked", &promptData, sizeof(locked_prompt_t), lockedFundsPrompt);
     return sub_rv;
 }
 
-void init_Input(struct Input_state *const state) {
-    state->state = 0;
-    INIT_SUBPARSER(uint32State, uint32_t);
+static enum parse_rv owners_threshold_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    PRINTF("Threshold: %d\n", (uint32_t)state->value);
+    if (meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET) {
+        uint32_t const threshold = state->value;
+        ADD_PROMPT("Threshold", &threshold, sizeof(threshold), number_to_string_indirect32);
+    }
+    return sub_rv;
 }
 
-enum parse_rv parse_Input(struct Input_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-
-    switch (state->state) {
-        case 0:
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->type = state->uint32State.val;
-            PRINTF("INPUT TYPE: %d\n", state->type);
-            state->state++;
-            switch (state->type) {
-                default: REJECT("Unrecognized input type");
-                case 0x00000005: // SECP256K1 transfer input
-                    INIT_SUBPARSER(secp256k1TransferInput, SECP256K1TransferInput);
-                    break;
-                case 0x00000015: // SECP256K1 transfer input
-                    INIT_SUBPARSER(stakeableLockInput, StakeableLockInput);
-                    break;
-            }
-            fallthrough;
-        case 1:
-            switch (state->type) {
-                default: REJECT("Unrecognized input type");
-                case 0x00000005: // SECP256K1 transfer input
-                    PRINTF("SECP256K1 Input\n");
-                    CALL_SUBPARSER(secp256k1TransferInput, SECP256K1TransferInput);
-                    break;
-                case 0x00000015: // SECP256K1 transfer input
-                    CALL_SUBPARSER(stakeableLockInput, StakeableLockInput);
-                    break;
-            }
+static enum parse_rv owners_address_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    address_prompt_t address_prompt;
+    memset(&address_prompt, 0, sizeof(address_prompt));
+    address_prompt.network_id = meta->network_id;
+    memcpy(&address_prompt.address, state->bytes, sizeof(address_prompt.address));
+    if (meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET) {
+        ADD_PROMPT("Address", &address_prompt, sizeof(address_prompt_t), output_address_to_string);
+    } else {
+        ADD_PROMPT("Rewards To", &address_prompt, sizeof(address_prompt_t), output_address_to_string);
     }
-
     return sub_rv;
 }
 
-void init_TransferableInput(struct TransferableInput_state *const state) {
-    state->state = 0;
-    INIT_SUBPARSER(id32State, Id32);
+static enum parse_rv validator_node_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    address_prompt_t pkh_prompt;
+    pkh_prompt.network_id = meta->network_id;
+    memcpy(&pkh_prompt.address, state->bytes, sizeof(pkh_prompt.address));
+    ADD_PROMPT("Validator", &pkh_prompt, sizeof(address_prompt_t), validator_to_string);
+    return sub_rv;
 }
 
-enum parse_rv parse_TransferableInput(struct TransferableInput_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-        case 0: // tx_id
-            CALL_SUBPARSER(id32State, Id32);
-            state->state++;
-            PRINTF("TX_ID: %.*h\n", 32, state->id32State.buf);
-            INIT_SUBPARSER(uint32State, uint32_t);
-            fallthrough;
-        case 1: // utxo_index
-            CALL_SUBPARSER(uint32State, uint32_t);
-            PRINTF("UTXO_INDEX: %u\n", state->uint32State.val);
-            state->state++;
-            INIT_SUBPARSER(id32State, Id32);
-            fallthrough;
-        case 2: // asset_id
-            CALL_SUBPARSER(id32State, Id32);
-            PRINTF("ASSET ID: %.*h\n", 32, state->id32State.buf);
-            check_asset_id(&state->id32State.val, meta);
-            state->state++;
-            INIT_SUBPARSER(inputState, Input);
-            fallthrough;
-        case 3: // Input
-            CALL_SUBPARSER(inputState, Input);
-    }
+static enum parse_rv validator_start_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    ADD_PROMPT("Start time", &state->value, sizeof(uint64_t), time_to_string_void_ret);
     return sub_rv;
 }
 
-IMPL_ARRAY(TransferableOutput);
-IMPL_ARRAY(TransferableInput);
-
-void init_Memo(struct Memo_state *const state) {
-    state->state = 0;
-    state->n = 0;
-    state->i = 0;
-    INIT_SUBPARSER(uint32State, uint32_t);
+static enum parse_rv validator_end_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    ADD_PROMPT("End time", &state->value, sizeof(uint64_t), time_to_string_void_ret);
+    return sub_rv;
 }
 
-enum parse_rv parse_Memo(struct Memo_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-
-    switch (state->state) {
-        case 0:
-            CALL_SUBPARSER(uint32State, uint32_t);
-            state->n = state->uint32State.val;
-            state->state++;
-            fallthrough;
-        case 1: {
-            size_t available = meta->input.length - meta->input.consumed;
-            size_t needed = state->n - state->i;
-            size_t to_consume = available > needed ? needed : available;
-            state->i += to_consume;
-            PRINTF("Memo bytes: %.*h\n", to_consume, &meta->input.src[meta->input.consumed]);
-            meta->input.consumed += to_consume;
-            sub_rv = state->i == state->n ? PARSE_RV_DONE : PARSE_RV_NEED_MORE;
-        }
+static enum parse_rv validator_weight_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    meta->staking_weight = state->value;
+    if (meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR) {
+        ADD_PROMPT("Weight", &state->value, sizeof(uint64_t), number_to_string_indirect64);
+    } else {
+        ADD_PROMPT("Total Stake", &state->value, sizeof(uint64_t), nano_avax_to_string_indirect64);
     }
+    return sub_rv;
+}
 
+static enum parse_rv evm_output_address_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    (void)meta;
+    PRINTF("ADDRESS: %.*h\n", sizeof(Address), state->bytes);
+    memcpy(&state->held.address, state->bytes, sizeof(state->held.address));
+    return PARSE_RV_DONE;
+}
+
+static enum parse_rv evm_output_asset_hook(struct codec_state *const state, parser_meta_state_t *const meta) {
+    enum parse_rv sub_rv = PARSE_RV_DONE;
+    PRINTF("ASSET: %.*h\n", sizeof(Id32), state->bytes);
+    output_prompt_t output_prompt;
+    memset(&output_prompt, 0, sizeof(output_prompt));
+    if (!(meta->last_output_amount > 0)) REJECT("Assertion failed: last_output_amount > 0");
+    output_prompt.amount = meta->last_output_amount;
+    output_prompt.network_id = meta->network_id;
+    memcpy(&output_prompt.address, &state->held.address, sizeof(output_prompt.address));
+    ADD_PROMPT(
+          "Importing",
+          &output_prompt, sizeof(output_prompt),
+          output_prompt_to_string
+          );
     return sub_rv;
 }
 
+#define CODEC_HOOK(hook) hook
+CODEC_DEFINE_SCHEMAS()
+#undef CODEC_HOOK
+
 void initTransaction(struct TransactionState *const state) {
-    state->state = 0;
+    state->steps[TX_LEVEL_TRANSACTION] = 0;
     init_uint32_t(&state->uint32State);
     cx_sha256_init(&state->hash_state);
     INIT_SUBPARSER(uint16State, uint16_t);
@@ -857,8 +674,8 @@ static bool prompt_fee(parser_meta_state_t *const meta) {
     return should_flush(&meta->prompt);
 }
 
-void init_BaseTransactionHeader(struct BaseTransactionHeaderState *const state) {
-  state->state = BTSH_NetworkId; // We start on Network ID
+void init_BaseTransactionHeader(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = BTSH_NetworkId; // We start on Network ID
   INIT_SUBPARSER(uint32State, uint32_t);
 }
 
@@ -884,13 +701,14 @@ static enum opt_chain_role decode_chain_id(network_id_t const network_id, blockc
   }
 }
 
-enum parse_rv parse_BaseTransactionHeader(struct BaseTransactionHeaderState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_BaseTransactionHeader(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch(state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+    switch (*step) {
       case BTSH_NetworkId: {
             CALL_SUBPARSER(uint32State, uint32_t);
-            state->state++;
-            PRINTF("Network ID: %.*h\n", sizeof(state->uint32State.buf), state->uint32State.buf);
+            (*step)++;
+            PRINTF("Network ID: %d\n", state->uint32State.val);
             meta->network_id = parse_network_id(state->uint32State.val);
             INIT_SUBPARSER(bidState, blockchain_id_t);
       }
@@ -903,7 +721,7 @@ enum parse_rv parse_BaseTransactionHeader(struct BaseTransactionHeaderState *con
                 REJECT("Blockchain ID did not match expected value for network ID");
             }
             meta->chain = chain;
-            state->state++;
+            (*step)++;
       } fallthrough;
       case BTSH_Done:
         PRINTF("Done\n");
@@ -912,31 +730,32 @@ enum parse_rv parse_BaseTransactionHeader(struct BaseTransactionHeaderState *con
     return sub_rv;
 }
 
-void init_BaseTransaction(struct BaseTransactionState *const state) {
-  state->state = BTS_Outputs; // We start on Outputs
-  INIT_SUBPARSER(outputsState, TransferableOutputs);
+void init_BaseTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = BTS_Outputs; // We start on Outputs
+  INIT_SUBPARSER_WITH(codecState, codec, TransferableOutputs_schema);
 }
 
-enum parse_rv parse_BaseTransaction(struct BaseTransactionState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_BaseTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+    switch (*step) {
         case BTS_Outputs: // outputs
             PRINTF("Parsing outputs\n");
-            CALL_SUBPARSER(outputsState, TransferableOutputs);
+            CALL_SUBPARSER(codecState, codec);
             PRINTF("Done with outputs\n");
-            state->state++;
-            INIT_SUBPARSER(inputsState, TransferableInputs);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, TransferableInputs_schema);
             fallthrough;
         case BTS_Inputs: { // inputs
-            CALL_SUBPARSER(inputsState, TransferableInputs);
+            CALL_SUBPARSER(codecState, codec);
             PRINTF("Done with inputs\n");
-            state->state++;
-            INIT_SUBPARSER(memoState, Memo);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, Memo_schema);
         } fallthrough;
         case BTS_Memo: // memo
-            CALL_SUBPARSER(memoState, Memo);
+            CALL_SUBPARSER(codecState, codec);
             PRINTF("Done with memo;\n");
-            state->state++;
+            (*step)++;
             fallthrough;
         case BTS_Done:
             PRINTF("Done\n");
@@ -952,15 +771,16 @@ static bool is_pchain(blockchain_id_t *blockchain_id) {
   return true;
 }
 
-void init_ImportTransaction(struct ImportTransactionState *const state) {
-  state->state = 0;
+void init_ImportTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
   INIT_SUBPARSER(uint32State, uint32_t);
 }
 
-enum parse_rv parse_ImportTransaction(struct ImportTransactionState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_ImportTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
     bool showChainPrompt = false;
-      switch (state->state) {
+      switch (*step) {
         case 0: // ChainID
             CALL_SUBPARSER(bidState, blockchain_id_t);
             enum opt_chain_role counterpart_chain = decode_chain_id(meta->network_id, &state->bidState.val);
@@ -986,8 +806,8 @@ enum parse_rv parse_ImportTransaction(struct ImportTransactionState *const state
               }
               break;
             }
-            state->state++;
-            INIT_SUBPARSER(inputsState, TransferableInputs);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, TransferableInputs_schema);
             PRINTF("Done with ChainID;\n");
 
             static char const cChainLabel[]="C-chain";
@@ -1003,8 +823,8 @@ enum parse_rv parse_ImportTransaction(struct ImportTransactionState *const state
 
         case 1: {
             meta->swap_output = true;
-            CALL_SUBPARSER(inputsState, TransferableInputs);
-            state->state++;
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
             PRINTF("Done with source chain Address\n");
             break;
         }
@@ -1017,14 +837,15 @@ enum parse_rv parse_ImportTransaction(struct ImportTransactionState *const state
     return sub_rv;
 }
 
-void init_ExportTransaction(struct ExportTransactionState *const state) {
-  state->state = 0;
+void init_ExportTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
   INIT_SUBPARSER(uint32State, uint32_t);
 }
 
-enum parse_rv parse_ExportTransaction(struct ExportTransactionState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_ExportTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+    switch (*step) {
         case 0: // ChainID
             CALL_SUBPARSER(bidState, blockchain_id_t);
             enum opt_chain_role counterpart_chain = decode_chain_id(meta->network_id, &state->bidState.val);
@@ -1054,15 +875,15 @@ enum parse_rv parse_ExportTransaction(struct ExportTransactionState *const state
                 REJECT("Invalid Chain ID - must be P or C");
               }
             }
-            state->state++;
-            INIT_SUBPARSER(outputsState, TransferableOutputs);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, TransferableOutputs_schema);
             PRINTF("Done with ChainID;\n");
             fallthrough;
 
         case 1: {// PChain Dst
             meta->swap_output = true;
-            CALL_SUBPARSER(outputsState, TransferableOutputs);
-            state->state++;
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
             PRINTF("Done with destination chain Address\n");
             break;
         }
@@ -1075,124 +896,35 @@ enum parse_rv parse_ExportTransaction(struct ExportTransactionState *const state
     return sub_rv;
 }
 
-void init_EVMOutput(struct EVMOutput_state *const state) {
-  state->state = 0;
-  INIT_SUBPARSER(addressState, Address);
-}
-
-enum parse_rv parse_EVMOutput(struct EVMOutput_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-      case 0: { // Address
-          CALL_SUBPARSER(addressState, Address);
-          state->state++;
-          PRINTF("ADDRESS: %.*h\n", 20, state->addressState.buf);
-          INIT_SUBPARSER(uint32State, uint32_t);
-      } fallthrough;
-      case 1: { // Amount
-          CALL_SUBPARSER(uint64State, uint64_t);
-          PRINTF("AMOUNT: %x\n", state->uint64State.val);
-          if (__builtin_uaddll_overflow(state->uint64State.val, meta->sum_of_outputs, &meta->sum_of_outputs)) THROW_(EXC_MEMORY_ERROR, "Sum of outputs overflowed");
-          meta->last_output_amount = state->uint64State.val;
-          state->state++;
-          INIT_SUBPARSER(id32State, Id32);
-      } fallthrough;
-      case 2: { // AssetID
-          CALL_SUBPARSER(id32State, Id32);
-          PRINTF("ASSET: %.*h\n", 32, state->id32State.buf);
-          state->state++;
-      } fallthrough;
-      case 3: {
-          state->state++;
-          output_prompt_t output_prompt;
-          memset(&output_prompt, 0, sizeof(output_prompt));
-          if (!(meta->last_output_amount > 0)) REJECT("Assertion failed: last_output_amount > 0");
-          output_prompt.amount = meta->last_output_amount;
-          output_prompt.network_id = meta->network_id;
-          // addressState explicitly is not part of the ephemeral sub-states of
-          // EVMOutput_state so that this value is still available here.
-          memcpy(&output_prompt.address, &state->addressState.val,
-              sizeof(output_prompt.address));
-
-          ADD_PROMPT(
-                "Importing",
-                &output_prompt, sizeof(output_prompt),
-                output_prompt_to_string
-                );
-          BREAK_IF_PROMPT_FLUSH;
-      } fallthrough;
-      case 4:
-        sub_rv=PARSE_RV_DONE;
-    }
-    return sub_rv;
-}
-
-IMPL_ARRAY(EVMOutput);
-
-void init_EVMInput(struct EVMInput_state *const state) {
-  state->state = 0;
-  INIT_SUBPARSER(addressState, Address);
-}
-
-enum parse_rv parse_EVMInput(struct EVMInput_state *const state, parser_meta_state_t *const meta) {
-    enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
-      case 0: { // Address
-          CALL_SUBPARSER(addressState, Address);
-          state->state++;
-          PRINTF("ADDRESS: %.*h\n", 20, state->addressState.buf);
-          INIT_SUBPARSER(uint64State, uint64_t);
-      } fallthrough;
-      case 1: { // Amount
-          CALL_SUBPARSER(uint64State, uint64_t);
-          PRINTF("AMOUNT: %.*h\n", 8, &state->uint64State.val);
-            if (__builtin_uaddll_overflow(state->uint64State.val, meta->sum_of_inputs, &meta->sum_of_inputs)) THROW_(EXC_MEMORY_ERROR, "Sum of inputs overflowed");
-          state->state++;
-          INIT_SUBPARSER(id32State, Id32);
-      } fallthrough;
-      case 2: { // AssetID
-          CALL_SUBPARSER(id32State, Id32);
-          PRINTF("ASSET: %.*h\n", 32, state->id32State.buf);
-          INIT_SUBPARSER(uint64State, uint64_t);
-      } fallthrough;
-      case 3: { // nonce
-          CALL_SUBPARSER(uint64State, uint64_t);
-          PRINTF("NONCE: %.*h\n", 8, &state->uint64State.val);
-      }
-    }
-    return sub_rv;
-}
-
-IMPL_ARRAY(EVMInput);
-
-void init_CChainImportTransaction(struct CChainImportTransactionState *const state) {
-  state->state = 0;
+void init_CChainImportTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
   INIT_SUBPARSER(uint32State, uint32_t);
 }
 
-enum parse_rv parse_CChainImportTransaction(struct CChainImportTransactionState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_CChainImportTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-      switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+      switch (*step) {
         case 0: // sourceChain
             CALL_SUBPARSER(bidState, blockchain_id_t);
             enum opt_chain_role chain = decode_chain_id(meta->network_id, &state->bidState.val);
             if (chain == OPT_CHAIN_INVAL) {
                 REJECT("Source Blockchain ID did not match expected value for network ID");
             }
-            state->state++;
-            INIT_SUBPARSER(inputsState, TransferableInputs);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, TransferableInputs_schema);
             PRINTF("Done with ChainID;\n");
             fallthrough;
         case 1: {
-            CALL_SUBPARSER(inputsState, TransferableInputs);
-            state->state++;
-            INIT_SUBPARSER(evmOutputsState, EVMOutputs);
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, EVMOutputs_schema);
             PRINTF("Done with TransferableInputs\n");
         } fallthrough;
         case 2: { // EVMOutputs
-            CALL_SUBPARSER(evmOutputsState, EVMOutputs);
+            CALL_SUBPARSER(codecState, codec);
             PRINTF("Done with EVMOutputs\n");
-            state->state++;
+            (*step)++;
         } fallthrough;
         case 3:
              // This is bc we call the parser recursively, and, at the end, it gets called with
@@ -1203,34 +935,35 @@ enum parse_rv parse_CChainImportTransaction(struct CChainImportTransactionState
     return sub_rv;
 }
 
-void init_CChainExportTransaction(struct CChainExportTransactionState *const state) {
-  state->state = 0;
+void init_CChainExportTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
   INIT_SUBPARSER(uint32State, uint32_t);
 }
 
-enum parse_rv parse_CChainExportTransaction(struct CChainExportTransactionState *const state, parser_meta_state_t *const meta) {
+enum parse_rv parse_CChainExportTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-      switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+      switch (*step) {
         case 0: // destinationChain
             CALL_SUBPARSER(bidState, blockchain_id_t);
             enum opt_chain_role chain = decode_chain_id(meta->network_id, &state->bidState.val);
             if (chain == OPT_CHAIN_INVAL) {
                 REJECT("Destination Blockchain ID did not match expected value for network ID");
             }
-            state->state++;
-            INIT_SUBPARSER(inputsState, EVMInputs);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, EVMInputs_schema);
             PRINTF("Done with ChainID;\n");
             fallthrough;
         case 1: { // Inputs
-            CALL_SUBPARSER(inputsState, EVMInputs);
-            state->state++;
-            INIT_SUBPARSER(outputsState, TransferableOutputs);
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, TransferableOutputs_schema);
             PRINTF("Done with EVMInputs\n");
         } fallthrough;
         case 2: { // TransferableOutputs
-            CALL_SUBPARSER(outputsState, TransferableOutputs);
+            CALL_SUBPARSER(codecState, codec);
             PRINTF("Done with TransferableOutputs\n");
-            state->state++;
+            (*step)++;
         } fallthrough;
         case 3:
              // This is bc we call the parser recursively, and, at the end, it gets called with
@@ -1241,99 +974,47 @@ enum parse_rv parse_CChainExportTransaction(struct CChainExportTransactionState
     return sub_rv;
 }
 
-void init_Validator(struct Validator_state *const state) {
-  state->state=0;
-  INIT_SUBPARSER(addressState, Address);
-}
-
-enum parse_rv parse_Validator(struct Validator_state *const state, parser_meta_state_t *const meta) {
-  enum parse_rv sub_rv = PARSE_RV_INVALID;
-  switch(state->state) {
-    case 0:
-      CALL_SUBPARSER(addressState, Address);
-      state->state++;
-
-      address_prompt_t pkh_prompt;
-      pkh_prompt.network_id = meta->network_id;
-      memcpy(&pkh_prompt.address, &state->addressState.val, sizeof(pkh_prompt.address));
-      ADD_PROMPT("Validator", &pkh_prompt, sizeof(address_prompt_t), validator_to_string);
-      INIT_SUBPARSER(uint64State, uint64_t);
-      RET_IF_PROMPT_FLUSH;
-      fallthrough; // NOTE
-    case 1:
-      CALL_SUBPARSER(uint64State, uint64_t);
-      state->state++;
-      ADD_PROMPT("Start time", &state->uint64State.val, sizeof(uint64_t), time_to_string_void_ret);
-      INIT_SUBPARSER(uint64State, uint64_t);
-      RET_IF_PROMPT_FLUSH;
-      fallthrough; // NOTE
-    case 2:
-      CALL_SUBPARSER(uint64State, uint64_t);
-      state->state++;
-      ADD_PROMPT("End time", &state->uint64State.val, sizeof(uint64_t), time_to_string_void_ret);
-      INIT_SUBPARSER(uint64State, uint64_t);
-      RET_IF_PROMPT_FLUSH;
-      fallthrough; // NOTE
-    case 3:
-      CALL_SUBPARSER(uint64State, uint64_t);
-      state->state++;
-      meta->staking_weight = state->uint64State.val;
-      if(meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR)
-      {
-        ADD_PROMPT("Weight", &state->uint64State.val, sizeof(uint64_t), number_to_string_indirect64);
-      }
-      else
-      {
-        ADD_PROMPT("Total Stake", &state->uint64State.val, sizeof(uint64_t), nano_avax_to_string_indirect64);
-      }
-      RET_IF_PROMPT_FLUSH;
-      fallthrough; // NOTE
-    case 4:
-      return PARSE_RV_DONE;
-  }
-  return sub_rv;
-}
-
-void init_AddValidatorTransaction(struct AddValidatorTransactionState *const state) {
-  state->state = 0;
-  INIT_SUBPARSER(validatorState, Validator);
+void init_AddValidatorTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
+  INIT_SUBPARSER_WITH(codecState, codec, Validator_schema);
 }
 
 // Also covers AddDelegator transactions; the structure is identical but
 // thresholds and result are different. We've already notified the user of
 // which we are doing before we reach this stage.
 enum parse_rv parse_AddValidatorTransaction(
-  struct AddValidatorTransactionState *const state,
+  struct TransactionState *const state,
   parser_meta_state_t *const meta)
 {
     enum parse_rv sub_rv = PARSE_RV_INVALID;
-    switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+    switch (*step) {
         case 0: // ChainID
-          CALL_SUBPARSER(validatorState, Validator);
-          state->state++;
-          INIT_SUBPARSER(outputsState, TransferableOutputs);
+          CALL_SUBPARSER(codecState, codec);
+          (*step)++;
+          INIT_SUBPARSER_WITH(codecState, codec, TransferableOutputs_schema);
           fallthrough;
         case 1: {// Value
             meta->swap_output = true;
-            CALL_SUBPARSER(outputsState, TransferableOutputs);
-            state->state++;
-            INIT_SUBPARSER(ownersState, SECP256K1OutputOwners);
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
+            INIT_SUBPARSER_WITH(codecState, codec, SECP256K1OutputOwners_schema);
         } fallthrough;
         case 2: {
             if ( meta->staking_weight != meta->staked ) REJECT("Stake total did not match sum of stake UTXOs: %.*h %.*h", 8, &meta->staking_weight, 8, &meta->staked);
-            CALL_SUBPARSER(ownersState, SECP256K1OutputOwners);
-            state->state++;
+            CALL_SUBPARSER(codecState, codec);
+            (*step)++;
             INIT_SUBPARSER(uint32State, uint32_t);
         } fallthrough;
         case 3: {
             // Add delegator transactions don't include shares.
             if(meta->type_id.p == TRANSACTION_P_CHAIN_TYPE_ID_ADD_DELEGATOR) {
               sub_rv = PARSE_RV_DONE;
-              state->state++;
+              (*step)++;
               break;
             }
             CALL_SUBPARSER(uint32State, uint32_t);
-            state->state++;
+            (*step)++;
             ADD_PROMPT("Delegation Fee", &state->uint32State.val, sizeof(uint32_t), delegation_fee_to_string);
             BREAK_IF_PROMPT_FLUSH;
         } fallthrough;
@@ -1346,33 +1027,34 @@ enum parse_rv parse_AddValidatorTransaction(
     return sub_rv;
 }
 
-void init_AddSNValidatorTransaction(struct AddSNValidatorTransactionState *const state) {
-  state->state = 0;
-  INIT_SUBPARSER(validatorState, Validator);
+void init_AddSNValidatorTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
+  INIT_SUBPARSER_WITH(codecState, codec, Validator_schema);
 }
 
 enum parse_rv parse_AddSNValidatorTransaction(
-  struct AddSNValidatorTransactionState *const state,
+  struct TransactionState *const state,
   parser_meta_state_t *const meta)
 {
   enum parse_rv sub_rv = PARSE_RV_INVALID;
-  switch(state->state)
+  uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+  switch (*step)
   {
     case 0: //ChainID
-      CALL_SUBPARSER(validatorState, Validator);
-      state->state++;
+      CALL_SUBPARSER(codecState, codec);
+      (*step)++;
       INIT_SUBPARSER(id32State, Id32);
       fallthrough;
     case 1: {//Subnet ID
       CALL_SUBPARSER(id32State, Id32);
       ADD_PROMPT("Subnet", &state->id32State.val, sizeof(Id32), ids_to_string);
-      state->state++;
-      INIT_SUBPARSER(subnetauthState, SubnetAuth);
+      (*step)++;
+      INIT_SUBPARSER_WITH(codecState, codec, SubnetAuth_schema);
       RET_IF_PROMPT_FLUSH;
     } fallthrough;
     case 2: {
-      CALL_SUBPARSER(subnetauthState, SubnetAuth);
-      state->state++;
+      CALL_SUBPARSER(codecState, codec);
+      (*step)++;
     } fallthrough;
     case 3:
       sub_rv = PARSE_RV_DONE;
@@ -1380,26 +1062,27 @@ enum parse_rv parse_AddSNValidatorTransaction(
   return sub_rv;
 }
 
-void init_Genesis(struct Genesis_state *const state)
+void init_Genesis(struct TransactionState *const state)
 {
-  state->state = 0;
-  INIT_SUBPARSER(gen_n_state, uint32_t);
+  state->steps[TX_LEVEL_ELEMENT] = 0;
+  INIT_SUBPARSER(uint32State, uint32_t);
 }
 
-enum parse_rv parse_Genesis(struct Genesis_state *const state, parser_meta_state_t *const meta)
+enum parse_rv parse_Genesis(struct TransactionState *const state, parser_meta_state_t *const meta)
 {
   enum parse_rv sub_rv = PARSE_RV_INVALID;
+  uint8_t *const step = &state->steps[TX_LEVEL_ELEMENT];
 rebranch:
-  switch(state->state)
+  switch (*step)
   {
     case 0: {
       // Number of bytes of Genesis Data
-      CALL_SUBPARSER(gen_n_state, uint32_t);
-      uint32_t temp = state->gen_n_state.val;
+      CALL_SUBPARSER(uint32State, uint32_t);
+      uint32_t temp = state->uint32State.val;
       state->gen_n = temp;
       state->gen_i = 0;
       cx_sha256_init(&state->genhash_state);
-      state->state++;
+      (*step)++;
       PRINTF("Gen Data Count\n");
     } fallthrough;
     case 1: {
@@ -1411,7 +1094,7 @@ rebranch:
 
       if (state->gen_i == state->gen_n)
       {
-        state->state++;
+        (*step)++;
         goto rebranch;
       }
 
@@ -1426,7 +1109,7 @@ rebranch:
       sub_rv = state->gen_i == state->gen_n ? PARSE_RV_DONE : PARSE_RV_NEED_MORE;
       RET_IF_NOT_DONE;
 
-      state->state++;
+      (*step)++;
     } fallthrough;
     case 2: {
       if (state->gen_i <  state->gen_n)
@@ -1435,7 +1118,7 @@ rebranch:
         THROW(EXC_MEMORY_ERROR);
       }
 
-      state->state++;
+      (*step)++;
       genhash_t temp_final_hash;
       finish_hash((cx_hash_t *const)&state->genhash_state, &temp_final_hash);
       ADD_PROMPT("Genesis Data", &temp_final_hash, sizeof(temp_final_hash), gendata_to_hex);
@@ -1450,23 +1133,24 @@ rebranch:
 
 
 
-void init_CreateSubnetTransaction(struct CreateSubnetTransactionState *const state)
+void init_CreateSubnetTransaction(struct TransactionState *const state)
 {
-  state->state = 0;
-  INIT_SUBPARSER(ownersState, SECP256K1OutputOwners);
+  state->steps[TX_LEVEL_SECTION] = 0;
+  INIT_SUBPARSER_WITH(codecState, codec, SECP256K1OutputOwners_schema);
 }
 
 enum parse_rv parse_CreateSubnetTransaction(
-     struct CreateSubnetTransactionState *const state,
+     struct TransactionState *const state,
      parser_meta_state_t *const meta)
 
 {
   enum parse_rv sub_rv = PARSE_RV_INVALID;
-  switch(state->state)
+  uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+  switch (*step)
   {
     case 0:
-      CALL_SUBPARSER(ownersState, SECP256K1OutputOwners);
-      state->state++;
+      CALL_SUBPARSER(codecState, codec);
+      (*step)++;
       fallthrough;
     case 1:
       sub_rv = PARSE_RV_DONE;
@@ -1475,22 +1159,23 @@ enum parse_rv parse_CreateSubnetTransaction(
   return sub_rv;
 }
 
-void init_ChainName(struct ChainName_state *const state)
+void init_ChainName(struct TransactionState *const state)
 {
-  state->state = 0;
+  state->steps[TX_LEVEL_ELEMENT] = 0;
   INIT_SUBPARSER(uint16State, uint16_t);
 }
 
-enum parse_rv parse_ChainName(struct ChainName_state *const state, parser_meta_state_t *const meta)
+enum parse_rv parse_ChainName(struct TransactionState *const state, parser_meta_state_t *const meta)
 {
   enum parse_rv sub_rv = PARSE_RV_INVALID;
+  uint8_t *const step = &state->steps[TX_LEVEL_ELEMENT];
 rebranch:
-  switch(state->state)
+  switch (*step)
   {
     case 0:
       // Number of bytes in Chain Name
       CALL_SUBPARSER(uint16State, uint16_t);
-      state->state++;
+      (*step)++;
       state->name.buffer_size = state->uint16State.val;
       state->chainN_i = 0;
       memset(state->name.buffer, 0, sizeof(state->name.buffer));
@@ -1509,7 +1194,7 @@ rebranch:
 
       if (state->chainN_i == state->name.buffer_size)
       {
-        state->state++;
+        (*step)++;
         goto rebranch;
       }
 
@@ -1524,7 +1209,7 @@ rebranch:
       sub_rv = state->chainN_i == state->name.buffer_size ? PARSE_RV_DONE : PARSE_RV_NEED_MORE;
       RET_IF_NOT_DONE;
 
-      state->state++;
+      (*step)++;
     } fallthrough;
     case 2: {
       if (state->chainN_i <  state->name.buffer_size)
@@ -1532,7 +1217,7 @@ rebranch:
         PRINTF("Should not have gotten here yet\n");
         THROW(EXC_MEMORY_ERROR);
       }
-      state->state++;
+      (*step)++;
       ADD_PROMPT("Chain Name", &state->name, sizeof(state->name), chainname_to_string);
       RET_IF_PROMPT_FLUSH;
     } fallthrough;
@@ -1543,36 +1228,37 @@ rebranch:
   return sub_rv;
 }
 
-void init_CreateChainTransaction(struct CreateChainTransactionState *const state) {
-  state->state = 0;
+void init_CreateChainTransaction(struct TransactionState *const state) {
+  state->steps[TX_LEVEL_SECTION] = 0;
   state->fxid_i = 0;
   INIT_SUBPARSER(id32State, Id32);
 }
 
 enum parse_rv parse_CreateChainTransaction(
-  struct CreateChainTransactionState *const state,
+  struct TransactionState *const state,
   parser_meta_state_t *const meta)
 {
   enum parse_rv sub_rv = PARSE_RV_INVALID;
-  switch(state->state)
+  uint8_t *const step = &state->steps[TX_LEVEL_SECTION];
+  switch (*step)
   {
     case 0: // Subnet ID
       CALL_SUBPARSER(id32State, Id32);
       ADD_PROMPT("Subnet", &state->id32State.val, sizeof(Id32), ids_to_string);
-      state->state++;
-      INIT_SUBPARSER(chainnameState, ChainName);
+      (*step)++;
+      INIT_LEVEL(ChainName);
       fallthrough;
     case 1: { // chain name
-      CALL_SUBPARSER(chainnameState, ChainName);
+      CALL_LEVEL(ChainName);
       PRINTF("Done with Chain Name\n");
-      state->state++;
+      (*step)++;
       INIT_SUBPARSER(id32State, Id32);
     } fallthrough;
     case 2: {
       CALL_SUBPARSER(id32State, Id32);
       //PRINTF("VM ID: %.*h\n", 32, state->id32State.buf);
       ADD_PROMPT("VM ID", &state->id32State.val, sizeof(Id32), ids_to_string);
-      state->state++;
+      (*step)++;
       INIT_SUBPARSER(uint32State, uint32_t);
       RET_IF_PROMPT_FLUSH;
     } fallthrough;
@@ -1580,14 +1266,14 @@ enum parse_rv parse_CreateChainTransaction(
       CALL_SUBPARSER(uint32State, uint32_t);
       PRINTF("Num of fxids\n");
       state->fxid_n = state->uint32State.val;
-      state->state++;
+      (*step)++;
       INIT_SUBPARSER(id32State, Id32);
     } fallthrough;
     case 4: {
       if(state->fxid_i == state->fxid_n)
       {
-        state->state++;
-        INIT_SUBPARSER(genesisState, Genesis);
+        (*step)++;
+        INIT_LEVEL(Genesis);
         break;
       }
       do
@@ -1610,20 +1296,20 @@ enum parse_rv parse_CreateChainTransaction(
         }
         else
         {
-          state->state++;
-          INIT_SUBPARSER(genesisState, Genesis);
+          (*step)++;
+          INIT_LEVEL(Genesis);
           break;
         }
       } while(false);
     } fallthrough;
     case 5: {
-      CALL_SUBPARSER(genesisState, Genesis);
-      state->state++;
-      INIT_SUBPARSER(subnetauthState, SubnetAuth);
+      CALL_LEVEL(Genesis);
+      (*step)++;
+      INIT_SUBPARSER_WITH(codecState, codec, SubnetAuth_schema);
     } fallthrough;
     case 6: {
-      CALL_SUBPARSER(subnetauthState, SubnetAuth);
-      state->state++;
+      CALL_SUBPARSER(codecState, codec);
+      (*step)++;
     } fallthrough;
     case 7:
       sub_rv = PARSE_RV_DONE;
@@ -1688,6 +1374,12 @@ static label_t type_id_to_label(union transaction_type_id_t type_id, enum chain_
         BREAK_IF_NOT_DONE; \
     }
 
+#define CALL_LEVEL_BREAK(subParser) { \
+        sub_rv = parse_ ## subParser(state, meta); \
+        PRINTF(#subParser " RV: %d\n", sub_rv); \
+        BREAK_IF_NOT_DONE; \
+    }
+
 enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta_state_t *const meta) {
     check_null(state);
     check_null(meta);
@@ -1696,12 +1388,13 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
     PRINTF("***Parse Transaction***\n");
     enum parse_rv sub_rv = PARSE_RV_INVALID;
     size_t const start_consumed = meta->input.consumed;
-    switch (state->state) {
+    uint8_t *const step = &state->steps[TX_LEVEL_TRANSACTION];
+    switch (*step) {
         case 0: // codec ID
             CALL_SUBPARSER_BREAK(uint16State, uint16_t);
             PRINTF("Codec ID: %d\n", state->uint16State.val);
             if (state->uint16State.val != 0) REJECT("Only codec ID 0 is supported");
-            state->state++;
+            (*step)++;
             INIT_SUBPARSER(uint32State, uint32_t);
             fallthrough;
         case 1: { // type ID
@@ -1710,17 +1403,17 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
 
             // Rejects invalid tx types
             meta->raw_type_id = state->type;
-            state->state++;
-            PRINTF("Type ID: %.*h\n", sizeof(state->uint32State.buf), state->uint32State.buf);
+            (*step)++;
+            PRINTF("Type ID: %d\n", state->uint32State.val);
 
-            INIT_SUBPARSER(baseTxHdrState, BaseTransactionHeader);
+            INIT_LEVEL(BaseTransactionHeader);
         } fallthrough;
         case 2: { // Base transaction header
-            CALL_SUBPARSER_BREAK(baseTxHdrState, BaseTransactionHeader);
+            CALL_LEVEL_BREAK(BaseTransactionHeader);
             PRINTF("Parsed BTH\n");
             meta->type_id = convert_type_id_to_type(meta->raw_type_id, meta->chain);
-            state->state++;
-            INIT_SUBPARSER(baseTxState, BaseTransaction);
+            (*step)++;
+            INIT_LEVEL(BaseTransaction);
             label_t label = type_id_to_label(meta->type_id, meta->chain);
             ADD_PROMPT("Sign", label.label, label.label_size, strcpy_prompt);
             BREAK_IF_PROMPT_FLUSH;
@@ -1730,7 +1423,7 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
               case CHAIN_X:
               case CHAIN_P:
                 PRINTF("TRACE pre basic tx subparser break, chain enum: %d\n", meta->chain);
-                CALL_SUBPARSER_BREAK(baseTxState, BaseTransaction);
+                CALL_LEVEL_BREAK(BaseTransaction);
                 PRINTF("TRACE post basic tx subparser\n");
                 break;
               case CHAIN_C:
@@ -1741,40 +1434,40 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
             }
             BREAK_IF_NOT_DONE;
 
-            state->state++;
+            (*step)++;
             switch (meta->chain) {
             case CHAIN_X:
               switch (meta->type_id.x) {
               case TRANSACTION_X_CHAIN_TYPE_ID_BASE:
                 break;
               case TRANSACTION_X_CHAIN_TYPE_ID_IMPORT:
-                INIT_SUBPARSER(importTxState, ImportTransaction);
+                INIT_LEVEL(ImportTransaction);
                 break;
               case TRANSACTION_X_CHAIN_TYPE_ID_EXPORT:
-                INIT_SUBPARSER(exportTxState, ExportTransaction);
+                INIT_LEVEL(ExportTransaction);
                 break;
               };
               break;
             case CHAIN_P:
               switch (meta->type_id.p) {
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR:
-                INIT_SUBPARSER(addSNValidatorTxState, AddSNValidatorTransaction);
+                INIT_LEVEL(AddSNValidatorTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_CHAIN:
-                INIT_SUBPARSER(createChainTxState, CreateChainTransaction);
+                INIT_LEVEL(CreateChainTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET:
-                INIT_SUBPARSER(createSubnetTxState, CreateSubnetTransaction);
+                INIT_LEVEL(CreateSubnetTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_VALIDATOR:
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_DELEGATOR:
-                INIT_SUBPARSER(addValidatorTxState, AddValidatorTransaction);
+                INIT_LEVEL(AddValidatorTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_IMPORT:
-                INIT_SUBPARSER(importTxState, ImportTransaction);
+                INIT_LEVEL(ImportTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_EXPORT:
-                INIT_SUBPARSER(exportTxState, ExportTransaction);
+                INIT_LEVEL(ExportTransaction);
                 break;
               default:
                 REJECT("Only base, export, and import transactions are supported");
@@ -1783,10 +1476,10 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
             case CHAIN_C:
               switch (meta->type_id.c) {
               case TRANSACTION_C_CHAIN_TYPE_ID_IMPORT:
-                INIT_SUBPARSER(cChainImportState, CChainImportTransaction);
+                INIT_LEVEL(CChainImportTransaction);
                 break;
               case TRANSACTION_C_CHAIN_TYPE_ID_EXPORT:
-                INIT_SUBPARSER(cChainExportState, CChainExportTransaction);
+                INIT_LEVEL(CChainExportTransaction);
                 break;
               default:
                 REJECT("Only base, export, and import transactions are supported");
@@ -1801,33 +1494,33 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
                 sub_rv = PARSE_RV_DONE;
                 break;
               case TRANSACTION_X_CHAIN_TYPE_ID_IMPORT:
-                CALL_SUBPARSER_BREAK(importTxState, ImportTransaction);
+                CALL_LEVEL_BREAK(ImportTransaction);
                 break;
               case TRANSACTION_X_CHAIN_TYPE_ID_EXPORT:
-                CALL_SUBPARSER_BREAK(exportTxState, ExportTransaction);
+                CALL_LEVEL_BREAK(ExportTransaction);
                 break;
               }
               break;
             case CHAIN_P:
               switch (meta->type_id.p) {
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_SN_VALIDATOR:
-                CALL_SUBPARSER_BREAK(addSNValidatorTxState, AddSNValidatorTransaction);
+                CALL_LEVEL_BREAK(AddSNValidatorTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_CHAIN:
-                CALL_SUBPARSER_BREAK(createChainTxState, CreateChainTransaction);
+                CALL_LEVEL_BREAK(CreateChainTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_CREATE_SUBNET:
-                CALL_SUBPARSER_BREAK(createSubnetTxState, CreateSubnetTransaction);
+                CALL_LEVEL_BREAK(CreateSubnetTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_VALIDATOR:
               case TRANSACTION_P_CHAIN_TYPE_ID_ADD_DELEGATOR:
-                CALL_SUBPARSER_BREAK(addValidatorTxState, AddValidatorTransaction);
+                CALL_LEVEL_BREAK(AddValidatorTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_IMPORT:
-                CALL_SUBPARSER_BREAK(importTxState, ImportTransaction);
+                CALL_LEVEL_BREAK(ImportTransaction);
                 break;
               case TRANSACTION_P_CHAIN_TYPE_ID_EXPORT:
-                CALL_SUBPARSER_BREAK(exportTxState, ExportTransaction);
+                CALL_LEVEL_BREAK(ExportTransaction);
                 break;
               default:
                 REJECT("Only base, export, and import transactions are supported");
@@ -1836,23 +1529,23 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
             case CHAIN_C:
               switch (meta->type_id.c) {
               case TRANSACTION_C_CHAIN_TYPE_ID_IMPORT:
-                CALL_SUBPARSER_BREAK(cChainImportState, CChainImportTransaction);
+                CALL_LEVEL_BREAK(CChainImportTransaction);
                 break;
               case TRANSACTION_C_CHAIN_TYPE_ID_EXPORT:
-                CALL_SUBPARSER_BREAK(cChainExportState, CChainExportTransaction);
+                CALL_LEVEL_BREAK(CChainExportTransaction);
                 break;
               default:
                 REJECT("Only base, export, and import transactions are supported");
               }
             }
             BREAK_IF_NOT_DONE;
-            state->state++;
+            (*step)++;
         } fallthrough;
         case 5: {
                   PRINTF("Prompting for fee\n");
                   if (prompt_fee(meta))
                       sub_rv = PARSE_RV_PROMPT;
-                  state->state++;
+                  (*step)++;
                   PRINTF("Prompted for fee\n");
                   BREAK_IF_PROMPT_FLUSH;
         } fallthrough;
@@ -1866,5 +1559,7 @@ enum parse_rv parseTransaction(struct TransactionState *const state, parser_meta
         update_hash(&state->hash_state, &meta->input.src[start_consumed], consume_next);
     }
     PRINTF("Consumed %d bytes of input so far\n", meta->input.consumed);
+    TRACE(TRACE_PARSE, *step, meta->input.consumed);
+    PARSE_STATS_RV(meta->stats, sub_rv);
     return sub_rv;
 }
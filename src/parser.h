@@ -4,6 +4,8 @@
 #include "identifier.h"
 #include "uint256.h"
 #include "network_info.h"
+#include "parse_stats.h"
+#include "erc20_cache.h"
 
 // some global definitions
 enum parse_rv {
@@ -45,17 +47,6 @@ struct FixedState0 {
     name val; \
   };
 
-#define DEFINE_ARRAY(name) \
-    struct name ## s_state { \
-        int state; \
-        uint32_t len; \
-        uint32_t i; \
-        union { \
-            struct uint32_t_state len_state;\
-            struct name ## _state item; \
-        }; \
-    };
-
 DEFINE_FIXED(uint8_t);
 DEFINE_FIXED_BE(uint16_t);
 DEFINE_FIXED_BE(uint32_t);
@@ -72,53 +63,35 @@ DEFINE_FIXED(Address);
 
 #define NUMBER_STATES struct uint32_t_state uint32State; struct uint64_t_state uint64State
 
-struct SECP256K1TransferOutput_state {
-    int state;
-    uint32_t address_n;
-    uint32_t address_i;
-    union {
-        NUMBER_STATES;
-        struct Address_state addressState;
-    };
-};
-
-struct SECP256K1OutputOwners_state {
-    int state;
-    uint32_t address_n;
-    uint32_t address_i;
-    union {
-        NUMBER_STATES;
-        struct Address_state addressState;
-    };
-};
-
-struct SubnetAuth_state {
-  int state;
-  uint32_t sigindices_i;
-  uint32_t sigindices_n;
-  union {
-      NUMBER_STATES;
-  };
-};
+// State for the table-driven codec interpreter in parser.c. Schemas are static
+// tables of fields; nested structs push a frame instead of nesting states.
+struct codec_field;
 
+#define CODEC_MAX_DEPTH 4
 
-struct StakeableLockOutput_state {
-    int state;
-    uint64_t locktime;
-    union {
-        NUMBER_STATES;
-        struct SECP256K1TransferOutput_state secp256k1TransferOutput;
-    };
+struct codec_frame {
+    struct codec_field const *schema;
+    uint32_t array_i;
+    uint32_t array_n;
 };
 
-struct Output_state {
-    int state;
-    uint32_t type;
+// Wider members first and the per-frame field indexes kept apart from the
+// frames, so that neither leaves padding behind.
+struct codec_state {
+    uint64_t value; // last integer read, decoded
     union {
-        NUMBER_STATES;
-        struct SECP256K1TransferOutput_state secp256k1TransferOutput;
-        struct StakeableLockOutput_state stakeableLockOutput;
-    };
+        uint64_t u64;
+        Address address;
+    } held; // Scratch for hooks that need a field after later fields were read
+    uint8_t const *bytes; // Bytes of the field just read; valid until parse_codec returns
+    struct {
+        size_t filledTo;
+        uint8_t buf[sizeof(Id32)];
+    } fixed; // Laid out as struct FixedState
+    struct codec_frame stack[CODEC_MAX_DEPTH];
+    uint8_t field[CODEC_MAX_DEPTH]; // index of the field being parsed in each frame's schema
+    uint8_t depth;
+    bool skipping; // CODEC_SKIP length is known; value counts the bytes left
 };
 
 DEFINE_FIXED(blockchain_id_t);
@@ -127,18 +100,6 @@ DEFINE_FIXED(blockchain_id_t);
 
 typedef uint8_t genhash_t[GEN_HASH_SIZE];
 
-struct Genesis_state {
-  int state;
-  union {
-    struct uint32_t_state gen_n_state;
-    struct {
-      size_t gen_n;
-      size_t gen_i;
-      cx_sha256_t genhash_state;
-    };
-  };
-};
-
 #define CHAIN_NAME_MAX_SIZE 128
 
 typedef struct {
@@ -146,115 +107,12 @@ typedef struct {
     uint8_t buffer[CHAIN_NAME_MAX_SIZE];
 } chainname_prompt_t;
 
-struct ChainName_state{
-  int state;
-  union {
-    struct uint16_t_state uint16State;
-    struct {
-      chainname_prompt_t name;
-      uint16_t chainN_i;
-    };
-  };
-};
-
-
-struct TransferableOutput_state {
-    int state;
-    union {
-        struct Id32_state id32State;
-        struct blockchain_id_t_state bidState;
-        struct Output_state outputState;
-    };
-};
-
-DEFINE_ARRAY(TransferableOutput);
-
-struct SECP256K1TransferInput_state {
-    int state;
-    uint32_t address_index_n;
-    uint32_t address_index_i;
-    union {
-        NUMBER_STATES;
-        struct Address_state addressState;
-    };
-};
-
-struct StakeableLockInput_state {
-    int state;
-    union {
-        NUMBER_STATES;
-        struct SECP256K1TransferInput_state secp256k1TransferInput;
-    };
-};
-
-struct Input_state {
-    int state;
-    uint32_t type;
-    union {
-        NUMBER_STATES;
-        struct SECP256K1TransferInput_state secp256k1TransferInput;
-        struct StakeableLockInput_state stakeableLockInput;
-    };
-};
-
-struct TransferableInput_state {
-    int state;
-    union {
-        NUMBER_STATES;
-        struct Id32_state id32State;
-        struct Input_state inputState;
-    };
-};
-
-
-DEFINE_ARRAY(TransferableInput);
-
-struct EVMOutput_state {
-    int state;
-    struct Address_state addressState;
-    union {
-        NUMBER_STATES;
-        struct Id32_state id32State;
-    };
-};
-
-DEFINE_ARRAY(EVMOutput);
-
-struct EVMInput_state {
-    int state;
-    union {
-        NUMBER_STATES;
-        struct Id32_state id32State;
-        struct Address_state addressState;
-    };
-};
-
-DEFINE_ARRAY(EVMInput);
-
-struct Memo_state {
-    int state;
-    uint32_t n;
-    uint32_t i;
-    union {
-        NUMBER_STATES;
-    };
-};
-
 enum BaseTransactionHeaderSteps {
     BTSH_NetworkId = 0,
     BTSH_BlockchainId,
     BTSH_Done
 };
 
-struct BaseTransactionHeaderState {
-    enum BaseTransactionHeaderSteps state;
-    union {
-        struct uint16_t_state uint16State;
-        struct uint32_t_state uint32State;
-        struct blockchain_id_t_state bidState;
-    };
-};
-
 enum BaseTransactionSteps {
   BTS_Outputs=0,
   BTS_Inputs,
@@ -262,131 +120,37 @@ enum BaseTransactionSteps {
   BTS_Done
 };
 
-struct BaseTransactionState {
-    enum BaseTransactionSteps state;
-    union {
-        struct uint16_t_state uint16State;
-        struct uint32_t_state uint32State;
-        struct Id32_state id32State;
-        struct TransferableOutputs_state outputsState;
-        struct TransferableInputs_state inputsState;
-        struct Memo_state memoState;
-    };
-};
-
-struct CChainImportTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct blockchain_id_t_state bidState;
-        struct TransferableInputs_state inputsState;
-        struct EVMOutputs_state evmOutputsState;
-  };
-};
-
-struct CChainExportTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct blockchain_id_t_state bidState;
-        struct TransferableOutputs_state outputsState;
-        struct EVMInputs_state inputsState;
-  };
-};
-
-struct ImportTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct blockchain_id_t_state bidState;
-        struct TransferableInputs_state inputsState;
-  };
-};
-
-struct ExportTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct blockchain_id_t_state bidState;
-        struct TransferableOutputs_state outputsState;
-  };
-};
-struct Validator_state {
-  int state;
-  union {
-    struct Address_state addressState;
-    struct uint64_t_state uint64State;
-  };
-};
-
-struct AddValidatorTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct Id32_state id32State;
-        struct TransferableOutputs_state outputsState;
-
-        struct Validator_state validatorState;
-        struct SECP256K1OutputOwners_state ownersState;
-  };
-};
-
-struct AddSNValidatorTransactionState {
-  int state;
-  union {
-        struct Validator_state validatorState;
-        struct Id32_state id32State;
-        struct SubnetAuth_state subnetauthState;
-  };
-};
-
-struct CreateSubnetTransactionState {
-  int state;
-  union {
-        struct SECP256K1OutputOwners_state ownersState;
-  };
-};
-
-struct AddDelegatorTransactionState {
-  int state;
-  union {
-        struct uint32_t_state uint32State;
-        struct Id32_state id32State;
-        struct TransferableOutputs_state outputsState;
-  };
-};
-
-struct CreateChainTransactionState {
-  int state;
-  uint32_t fxid_n;
-  uint32_t fxid_i;
-  union {
-        struct uint32_t_state uint32State;
-        struct Id32_state id32State;
-        struct ChainName_state  chainnameState;
-        struct Genesis_state genesisState;
-        struct SubnetAuth_state subnetauthState;
-  };
+// Transaction parsing is a fixed-depth stack rather than a union per
+// transaction type: each level keeps only its step index, and whatever the
+// innermost level is reading lives in one union of leaf states.
+enum tx_parse_level {
+  TX_LEVEL_TRANSACTION, // codec ID, type ID, then each section in turn
+  TX_LEVEL_SECTION,     // base header, base body, or the type-specific body
+  TX_LEVEL_ELEMENT,     // chain name or genesis data inside a CreateChain body
+  TX_PARSE_DEPTH
 };
 
 struct TransactionState {
-  int state;
+  uint8_t steps[TX_PARSE_DEPTH];
   uint32_t type;
+  uint32_t fxid_n; // CreateChain feature extension IDs: count, and how many were read
+  uint32_t fxid_i;
   cx_sha256_t hash_state;
   union {
     struct uint16_t_state uint16State;
     struct uint32_t_state uint32State;
-    struct BaseTransactionHeaderState baseTxHdrState;
-    struct BaseTransactionState baseTxState;
-    struct ImportTransactionState importTxState;
-    struct ExportTransactionState exportTxState;
-    struct AddValidatorTransactionState addValidatorTxState;
-    struct AddSNValidatorTransactionState addSNValidatorTxState;
-    struct CreateChainTransactionState createChainTxState;
-    struct CreateSubnetTransactionState createSubnetTxState;
-    struct AddDelegatorTransactionState addDelegatorTxState;
-    struct CChainImportTransactionState cChainImportState;
-    struct CChainExportTransactionState cChainExportState;
+    struct Id32_state id32State;
+    struct blockchain_id_t_state bidState;
+    struct codec_state codecState;
+    struct {
+      chainname_prompt_t name;
+      uint16_t chainN_i;
+    };
+    struct {
+      size_t gen_n;
+      size_t gen_i;
+      cx_sha256_t genhash_state;
+    };
   };
 };
 
@@ -397,10 +161,10 @@ typedef struct {
 } parser_input_meta_state_t;
 
 #define MAX_CALLDATA_PREVIEW 20
+#define ABI_VALUE_PREVIEW_SIZE 24
 
 typedef struct {
   union {
-    uint64_t fee;
     uint64_t amount;
     uint256_t amount_big;
     uint64_t start_gas;
@@ -414,6 +178,22 @@ typedef struct {
       uint8_t buffer[MAX_CALLDATA_PREVIEW];
     } calldata_preview;
     uint8_t bytes32[32]; // ABI
+    struct {
+      uint32_t length;
+      uint8_t count; // Bytes of the value in preview
+      bool is_string;
+      bool hashed;
+      uint8_t preview[ABI_VALUE_PREVIEW_SIZE];
+      uint8_t hash[32]; // Keccak-256 of the whole value, when hashed
+    } abi_value; // ABI bytes or string
+    struct {
+      uint256_t amount; // Shares its offset with amount_big
+      erc20_token_t token;
+    } erc20_amount; // ABI amount of a provided ERC-20 token
+    struct {
+      uint32_t addresses;
+      uint32_t storage_keys;
+    } access_list;
   };
   network_id_t network_id;
   Address address;
@@ -503,8 +283,9 @@ typedef struct {
     uint64_t sum_of_outputs;
     uint64_t staking_weight;
     uint64_t staked;
-
-
+#ifdef AVA_PARSE_STATS
+    parse_stats_t stats;
+#endif
 } parser_meta_state_t;
 
 void set_next_batch_size(prompt_batch_t *const prompt, size_t size);
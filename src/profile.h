@@ -0,0 +1,45 @@
+#pragma once
+
+#include <stdint.h>
+
+// Opt-in profiling counters (PROFILE=1). Each instrumented region counts the
+// calls that completed; the table is read and reset with the profile
+// instruction. Regions have no timings: the app has no clock of its own, and
+// ticker events are not serviced while a handler runs, so they can't time one.
+// They are serviced while main_loop waits in io_exchange, so that wait is
+// counted in ticks, split by what it is waiting for.
+
+enum profile_region {
+    PROFILE_IO,        // io_exchange in main_loop: transport and user interaction
+    PROFILE_HANDLER,   // APDU handlers that return normally
+    PROFILE_DERIVE,    // BIP32 derivation and key pair generation
+    PROFILE_SIGN,      // cx_ecdsa_sign
+    PROFILE_HASH,      // Transaction hashing
+    PROFILE_PARSE,     // Transaction parser steps
+    PROFILE_TO_STRING, // Prompt value rendering
+    PROFILE_REGION_COUNT,
+};
+
+enum profile_wait {
+    PROFILE_WAIT_TRANSPORT, // For the host to send the next APDU
+    PROFILE_WAIT_USER,      // For the user to answer prompts, after an async reply
+    PROFILE_WAIT_COUNT,
+};
+
+#ifdef AVA_PROFILE
+
+extern uint32_t profile_calls[PROFILE_REGION_COUNT];
+extern uint32_t profile_wait_ticks[PROFILE_WAIT_COUNT];
+extern uint8_t profile_waiting; // enum profile_wait
+
+#define PROFILE_COUNT(region) (profile_calls[region]++)
+#define PROFILE_WAIT(wait) (profile_waiting = (wait))
+#define PROFILE_TICK() (profile_wait_ticks[profile_waiting]++)
+
+#else
+
+#define PROFILE_COUNT(region)
+#define PROFILE_WAIT(wait)
+#define PROFILE_TICK()
+
+#endif
@@ -0,0 +1,120 @@
+#include "pubkey_cache.h"
+
+#include "globals.h"
+#include "keys.h"
+#include "key_macros.h"
+
+#include <stddef.h>
+#include <string.h>
+
+// DO NOT TRY TO INIT THIS. Like N_data_real, it can only be written via nvm_write,
+// and the "N_" prefix is what puts it in NVRAM.
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+pubkey_cache_t const N_pubkey_cache_real;
+#   define N_pubkey_cache (*(volatile pubkey_cache_t *)PIC(&N_pubkey_cache_real))
+#else
+pubkey_cache_t N_pubkey_cache_real;
+#   define N_pubkey_cache (*(pubkey_cache_t *)PIC(&N_pubkey_cache_real))
+#endif
+
+static bool same_path(bip32_path_t const *const a, bip32_path_t const volatile *const b) {
+    if (a->length != b->length) return false;
+    for (size_t i = 0; i < a->length; i++) {
+        if (a->components[i] != b->components[i]) return false;
+    }
+    return true;
+}
+
+// Entries derived under another seed (a different passphrase, say) must never
+// be served, so before the cache is first touched each launch it is checked
+// against the chain code of m/44'/9000' and emptied if it does not match. The
+// chain code comes out of the hardened derivation itself, so unlike a public
+// key hash it costs no point multiplication. Only its SHA-256 is stored.
+static void check_seed_fingerprint(void) {
+    if (global.pubkey_cache_checked) return;
+
+    bip32_path_t const fingerprint_path = {2, {ROOT_PATH_0, ROOT_PATH_1}};
+    uint8_t chain_code[CHAIN_CODE_DATA_SIZE];
+    uint8_t hash[CX_SHA256_SIZE];
+    generate_chain_code(chain_code, &fingerprint_path);
+    cx_hash_sha256(chain_code, sizeof(chain_code), hash, sizeof(hash));
+    explicit_bzero(chain_code, sizeof(chain_code));
+
+    if (memcmp(hash, (void const *)N_pubkey_cache.seed_fingerprint, sizeof(public_key_hash_t)) != 0) {
+        PRINTF("Seed changed; clearing public key cache\n");
+        uint8_t const empty = 0;
+        for (size_t i = 0; i < PUBKEY_CACHE_SIZE; i++) {
+            if (N_pubkey_cache.entries[i].path.length == 0) continue;
+            nvm_write((void *)&N_pubkey_cache.entries[i].path.length, (void *)&empty, sizeof(empty));
+        }
+        nvm_write((void *)&N_pubkey_cache.seed_fingerprint, hash, sizeof(public_key_hash_t));
+    }
+    global.pubkey_cache_checked = true;
+}
+
+// Puts a copy of entry at the front of the RAM LRU, shifting entries
+// [0, from) back by one; whatever was at position from is overwritten.
+static cached_public_key_t const *lru_promote(cached_public_key_t const volatile *const entry, size_t const from) {
+    cached_public_key_t *const lru = global.pubkey_lru.entries;
+    cached_public_key_t promoted;
+    memcpy(&promoted, (void const *)entry, sizeof(promoted));
+    memmove(&lru[1], &lru[0], from * sizeof(lru[0]));
+    memcpy(&lru[0], &promoted, sizeof(lru[0]));
+    return &lru[0];
+}
+
+// A reset can interrupt any nvm_write, so an occupied slot is emptied first
+// and its path length, a single byte, is written last: a torn write leaves an
+// empty slot rather than one path paired with another's key. Empty slots are
+// filled before any is evicted, which skips the first write until the cache
+// is full.
+static void store_entry(cached_public_key_t const *const entry) {
+    uint8_t slot = N_pubkey_cache.next_slot % PUBKEY_CACHE_SIZE;
+    for (size_t i = 0; i < PUBKEY_CACHE_SIZE; i++) {
+        if (N_pubkey_cache.entries[i].path.length == 0) {
+            slot = i;
+            break;
+        }
+    }
+    cached_public_key_t volatile *const target = &N_pubkey_cache.entries[slot];
+    size_t const body = offsetof(cached_public_key_t, path.components);
+    if (target->path.length != 0) {
+        uint8_t const empty = 0;
+        nvm_write((void *)&target->path.length, (void *)&empty, sizeof(empty));
+    }
+    nvm_write((void *)&target->path.components, (void *)&entry->path.components, sizeof(*entry) - body);
+    nvm_write((void *)&target->path.length, (void *)&entry->path.length, sizeof(entry->path.length));
+    if (slot == N_pubkey_cache.next_slot % PUBKEY_CACHE_SIZE) {
+        uint8_t const next_slot = (slot + 1) % PUBKEY_CACHE_SIZE;
+        nvm_write((void *)&N_pubkey_cache.next_slot, (void *)&next_slot, sizeof(next_slot));
+    }
+    global.pubkey_cache_writes++;
+}
+
+cached_public_key_t const *cached_public_key(bip32_path_t const *const path) {
+    check_null(path);
+
+    for (size_t i = 0; i < PUBKEY_LRU_SIZE; i++) {
+        if (same_path(path, &global.pubkey_lru.entries[i].path)) {
+            return i == 0 ? &global.pubkey_lru.entries[0] : lru_promote(&global.pubkey_lru.entries[i], i);
+        }
+    }
+
+    check_seed_fingerprint();
+    for (size_t i = 0; i < PUBKEY_CACHE_SIZE; i++) {
+        if (same_path(path, &N_pubkey_cache.entries[i].path)) {
+            PRINTF("Public key cache hit in slot %d\n", i);
+            return lru_promote(&N_pubkey_cache.entries[i], PUBKEY_LRU_SIZE - 1);
+        }
+    }
+
+    cached_public_key_t entry;
+    memset(&entry, 0, sizeof(entry));
+    memcpy(&entry.path, path, sizeof(entry.path));
+    generate_extended_public_key(&entry.ext_public_key, path);
+    generate_pkh_for_pubkey(&entry.ext_public_key.public_key, &entry.avm_pkh);
+    generate_evm_pkh_for_pubkey(&entry.ext_public_key.public_key, &entry.evm_pkh);
+
+    if (global.pubkey_cache_writes < PUBKEY_CACHE_WRITES_PER_LAUNCH) store_entry(&entry);
+    return lru_promote(&entry, PUBKEY_LRU_SIZE - 1);
+}
@@ -0,0 +1,47 @@
+#pragma once
+
+#include "bolos_target.h"
+#include "types.h"
+
+// Public key material for one BIP32 path: everything the address and public
+// key instructions hand out, so a cache hit needs no EC math.
+typedef struct {
+    bip32_path_t path; // length 0 marks an empty slot
+    extended_public_key_t ext_public_key;
+    public_key_hash_t avm_pkh;
+    public_key_hash_t evm_pkh;
+} cached_public_key_t;
+
+#define PUBKEY_CACHE_SIZE 8
+
+// Kept in NVRAM, so it survives restarts and is wiped with the app. It only
+// ever holds public data. Entries are tied to the seed that produced them by
+// a fingerprint that is checked once per app launch, before the first lookup.
+typedef struct {
+    public_key_hash_t seed_fingerprint;
+    uint8_t next_slot; // Round-robin replacement
+    cached_public_key_t entries[PUBKEY_CACHE_SIZE];
+} pubkey_cache_t;
+
+// Most recently used entries, kept in RAM outside global.apdu so they survive
+// switching instructions. Entry 0 is the most recent. A hit here skips the
+// NVRAM scan too; Nano S can only spare room for one entry.
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define PUBKEY_LRU_SIZE 4
+#else
+#define PUBKEY_LRU_SIZE 1
+#endif
+
+typedef struct {
+    cached_public_key_t entries[PUBKEY_LRU_SIZE];
+} pubkey_lru_t;
+
+// Public key requests need no confirmation, so a wallet scanning for addresses
+// could otherwise rewrite flash on every one of them. Misses past this many
+// per app launch are only kept in the RAM LRU.
+#define PUBKEY_CACHE_WRITES_PER_LAUNCH 4
+
+// Returns the public key material for path, deriving it on a miss. Misses go
+// into the RAM LRU, and into NVRAM while the launch's write budget lasts.
+// The result points into the RAM LRU and stays valid until the next call.
+cached_public_key_t const *cached_public_key(bip32_path_t const *const path);
@@ -0,0 +1,15 @@
+#include "ram_budget.h"
+
+#define RAM_BUDGET_ASSERT(name, size, nanos_budget, large_budget) \
+    _Static_assert((size) <= RAM_BUDGET(nanos_budget, large_budget), "RAM budget exceeded by " #name);
+
+RAM_BUDGET_TABLE(RAM_BUDGET_ASSERT)
+
+#ifdef RAM_BUDGET_REPORT
+// Never linked: `make ram-report` reads these sizes back out of the object file.
+#define RAM_BUDGET_SYMBOLS(name, size, nanos_budget, large_budget) \
+    char const ram_size_ ## name[size] = {0}; \
+    char const ram_budget_ ## name[RAM_BUDGET(nanos_budget, large_budget)] = {0};
+
+RAM_BUDGET_TABLE(RAM_BUDGET_SYMBOLS)
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include "globals.h"
+
+// RAM budget for parser and APDU state. Each row names a struct or union
+// member, its size, and the most it may take on Nano S and on the larger
+// targets. ram_budget.c turns the rows into static asserts that name the row
+// that went over; `make ram-report` lists every size next to its budget.
+
+#define RAM_MEMBER_SIZE(type, member) sizeof(((type *)0)->member)
+// Bytes from the start of member first to the end of member last, for union
+// leaves that are anonymous structs.
+#define RAM_SPAN_SIZE(type, first, last) \
+    (offsetof(type, last) + RAM_MEMBER_SIZE(type, last) - offsetof(type, first))
+
+// X(name, size, nanos_budget, large_budget)
+#define RAM_BUDGET_TABLE(X) \
+    X(globals_t,                                 sizeof(globals_t),                                                 1984, 4096) \
+    X(globals_apdu,                              RAM_MEMBER_SIZE(globals_t, apdu),                                  1408, 2816) \
+    X(pubkey_lru_t,                              sizeof(pubkey_lru_t),                                               192,  768) \
+    X(precomputed_node_t,                        sizeof(precomputed_node_t),                                         160,  160) \
+    X(erc20_cache_t,                             sizeof(erc20_cache_t),                                               48,  320) \
+    X(sign_session_t,                            sizeof(sign_session_t),                                              16,   32) \
+    X(apdu_pubkey_state_t,                       sizeof(apdu_pubkey_state_t),                                        256,  512) \
+    X(apdu_sign_state_t,                         sizeof(apdu_sign_state_t),                                         1216, 2432) \
+    X(apdu_evm_sign_state_t,                     sizeof(apdu_evm_sign_state_t),                                     1408, 2816) \
+    X(apdu_evm_personal_sign_state_t,            sizeof(apdu_evm_personal_sign_state_t),                             640, 1280) \
+    X(apdu_evm_eip712_state_t,                   sizeof(apdu_evm_eip712_state_t),                                    704, 1408) \
+    X(prompt_batch_t,                            sizeof(prompt_batch_t),                                             576, 1152) \
+    X(parser_meta_state_t,                       sizeof(parser_meta_state_t),                                        768, 1536) \
+    X(TransactionState,                          sizeof(struct TransactionState),                                    288,  576) \
+    X(TransactionState_bidState,                 RAM_MEMBER_SIZE(struct TransactionState, bidState),                  64,  128) \
+    X(TransactionState_codecState,               RAM_MEMBER_SIZE(struct TransactionState, codecState),               160,  320) \
+    X(TransactionState_name,                     RAM_MEMBER_SIZE(struct TransactionState, name),                     160,  320) \
+    X(TransactionState_genesis,                  RAM_SPAN_SIZE(struct TransactionState, gen_n, genhash_state),       128,  256) \
+    X(codec_state,                               sizeof(struct codec_state),                                         160,  320) \
+    X(evm_parser_meta_state_t,                   sizeof(evm_parser_meta_state_t),                                    576, 1152) \
+    X(EVM_txn_state,                             sizeof(struct EVM_txn_state),                                       256,  512) \
+    X(EVM_RLP_txn_state,                         sizeof(struct EVM_RLP_txn_state),                                   256,  512) \
+    X(EVM_RLP_item_state,                        sizeof(struct EVM_RLP_item_state),                                  160,  320)
+
+#if defined(TARGET_NANOX) || defined(TARGET_NANOS2)
+#define RAM_BUDGET(nanos_budget, large_budget) (large_budget)
+#else
+#define RAM_BUDGET(nanos_budget, large_budget) (nanos_budget)
+#endif
@@ -0,0 +1,179 @@
+#include "sign_session.h"
+
+#include "apdu.h"
+#include "globals.h"
+#include "key_precompute.h"
+#include "profile.h"
+#include "trace.h"
+#include "to_string.h"
+#include "ui.h"
+
+#include <string.h>
+
+#define S global.apdu.session
+
+static inline sign_session_vtable_t const *vtable(void) {
+    return PIC(S.vtable);
+}
+
+static size_t next_parse(bool const is_reentry);
+
+static bool continue_parsing(void) {
+    PRINTF("Continue parsing\n");
+    prompt_batch_t *const prompt = PIC(vtable()->prompt)();
+    memset(prompt, 0, sizeof(*prompt));
+#ifdef AVA_PARSE_STATS
+    PIC(vtable()->stats)()->resumes++;
+#endif
+
+    BEGIN_TRY {
+        TRY {
+          // Call next_parse, which calls this function recursively...
+            next_parse(true);
+        }
+        CATCH(ASYNC_EXCEPTION) {
+            // requested another prompt
+            PRINTF("Caught nested ASYNC exception\n");
+        }
+        CATCH_OTHER(e) {
+            THROW(e);
+        }
+        FINALLY {}
+    }
+    END_TRY;
+    return true;
+}
+
+static void transaction_complete_prompt(void) {
+    static uint32_t const TYPE_INDEX = 0;
+
+    static char const *const transaction_prompts[] = {
+        PROMPT("Finalize"),
+        NULL,
+    };
+    REGISTER_STATIC_UI_VALUE(TYPE_INDEX, "Transaction");
+
+    precompute_key_arm();
+    ui_prompt(transaction_prompts, PIC(vtable()->ok), PIC(vtable()->reject));
+}
+
+static inline size_t reply_maybe_delayed(bool const is_reentry, size_t const tx) {
+    if (is_reentry) {
+        delayed_send(tx);
+    }
+    return tx;
+}
+
+static void empty_prompt_queue(prompt_batch_t *const prompt) {
+    if (prompt->count > 0) {
+        PRINTF("Prompting for %d fields\n", prompt->count);
+        TRACE(TRACE_PROMPT_FLUSH, prompt->count, 0);
+
+        for (size_t i = 0; i < prompt->count; i++) {
+            register_ui_callback(
+                i,
+                prompt->entries[i].to_string,
+                &prompt->entries[i].data
+            );
+        }
+        precompute_key_arm();
+        ui_prompt_with(ASYNC_EXCEPTION, "Next", prompt->labels, continue_parsing, PIC(vtable()->reject));
+    }
+}
+
+static size_t next_parse(bool const is_reentry) {
+    PRINTF("Next parse\n");
+    sign_session_vtable_t const *const vt = vtable();
+    prompt_batch_t *const prompt = PIC(vt->prompt)();
+    parser_input_meta_state_t const *const input = PIC(vt->input)();
+
+    enum parse_rv rv = PARSE_RV_INVALID;
+    BEGIN_TRY {
+      TRY {
+        do {
+          if (S.preview) {
+            memset(prompt, 0, sizeof(*prompt));
+          }
+          set_next_batch_size(prompt, PROMPT_MAX_BATCH_SIZE);
+          rv = PIC(vt->parse)();
+          PROFILE_COUNT(PROFILE_PARSE);
+        } while (S.preview && rv == PARSE_RV_PROMPT);
+      }
+      FINALLY {
+        switch (rv) {
+        case PARSE_RV_NEED_MORE:
+          break;
+        case PARSE_RV_INVALID:
+        case PARSE_RV_PROMPT:
+        case PARSE_RV_DONE:
+          if (!S.preview) {
+            empty_prompt_queue(prompt);
+          }
+          break;
+        }
+      }
+    }
+    END_TRY;
+
+    if ((rv == PARSE_RV_DONE || rv == PARSE_RV_NEED_MORE) &&
+        input->consumed != input->length)
+    {
+        PRINTF("Not all input was parsed: %d %d %d\n", rv, input->consumed, input->length);
+        THROW(EXC_PARSE_ERROR);
+    }
+
+    if (rv == PARSE_RV_NEED_MORE) {
+        if (vt->requires_last_message && S.is_last_message) {
+            PRINTF("Sender claimed last message and we aren't done\n");
+            THROW(EXC_PARSE_ERROR);
+        }
+        PRINTF("Need more\n");
+        return reply_maybe_delayed(is_reentry, finalize_successful_send(0));
+    }
+
+    if (rv == PARSE_RV_DONE) {
+        if (vt->requires_last_message && !S.is_last_message) {
+            PRINTF("Sender claims there is more but we are done\n");
+            THROW(EXC_PARSE_ERROR);
+        }
+
+        PIC(vt->finish_hash)();
+#ifdef AVA_PARSE_STATS
+        last_parse_stats = *PIC(vt->stats)();
+#endif
+        if (S.preview) {
+            PRINTF("Parser signaled done; sending preview\n");
+            size_t const tx = PIC(vt->preview_reply)();
+            memset(&S, 0, sizeof(S));
+            return finalize_successful_send(tx);
+        }
+        PRINTF("Parser signaled done; sending final prompt\n");
+        transaction_complete_prompt();
+    }
+
+    PRINTF("Parse error: %d %d %d\n", rv, input->consumed, input->length);
+    THROW(EXC_PARSE_ERROR);
+}
+
+void sign_session_start(sign_session_vtable_t const *const vt, bool const preview) {
+    if (preview && PIC(vt)->preview_reply == NULL) {
+        THROW_(EXC_WRONG_PARAM, "Flow has no preview mode");
+    }
+    S.vtable = vt;
+    S.is_last_message = false;
+    S.preview = preview;
+}
+
+size_t sign_session_feed(uint8_t const *const src, size_t const length, bool const is_last_message) {
+    if (S.vtable == NULL) THROW_(EXC_WRONG_PARAM, "Sender broke protocol order by going forward");
+
+    parser_input_meta_state_t *const input = PIC(vtable()->input)();
+    input->src = src;
+    input->consumed = 0;
+    input->length = length;
+#ifdef AVA_PARSE_STATS
+    parse_stats_chunk(PIC(vtable()->stats)(), length);
+#endif
+    S.is_last_message = is_last_message;
+    return next_parse(false);
+}
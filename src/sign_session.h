@@ -0,0 +1,35 @@
+#pragma once
+
+#include "parser.h"
+#include "types.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Everything that distinguishes one streaming signing flow from another. Instances
+// must be static const; the engine relocates every pointer with PIC before use.
+typedef struct {
+    enum parse_rv (*parse)(void);
+    prompt_batch_t *(*prompt)(void);
+    parser_input_meta_state_t *(*input)(void);
+    void (*finish_hash)(void); // Writes the flow's final hash once the parser is done
+    ui_callback_t ok;          // Called when the user accepts the final prompt
+    ui_callback_t reject;
+    size_t (*preview_reply)(void); // Builds the reply for parse-only sessions; NULL if unsupported
+    bool requires_last_message;    // Sender must flag the last chunk, and only the last chunk
+#ifdef AVA_PARSE_STATS
+    parse_stats_t *(*stats)(void);
+#endif
+} sign_session_vtable_t;
+
+typedef struct {
+    sign_session_vtable_t const *vtable;
+    bool is_last_message;
+    bool preview; // Drop prompts instead of showing them and never ask to sign
+} sign_session_t;
+
+// Starts a new session; the flow must already have initialized its parser.
+void sign_session_start(sign_session_vtable_t const *const vtable, bool const preview);
+
+// Points the parser at the next chunk of the transaction and runs it as far as it will go.
+size_t sign_session_feed(uint8_t const *const src, size_t const length, bool const is_last_message);
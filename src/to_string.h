@@ -25,6 +25,10 @@ size_t wei_to_navax_string(
 size_t wei_to_avax_or_navax_string_256(
     char dest[const], size_t const buff_size,
     uint256_t const *const wei);
+// Renders subunits with the given number of decimal digits, without a unit
+size_t subunit_to_unit_string_256(
+    char dest[const], size_t const buff_size,
+    const uint256_t *const subunits, uint8_t digits);
 
 void bip32_path_to_string(
     char out[const], size_t const out_size,
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+
+// Binary trace ring buffer (TRACE=1). Hot paths record fixed-size events
+// instead of formatting PRINTF output; the buffer is drained with the trace
+// instruction and decoded on the host by drainTrace in tests/common.ts.
+
+enum trace_event {
+    TRACE_APDU_BEGIN = 1, // state: instruction, offset: bytes received
+    TRACE_APDU_END,       // state: instruction, offset: bytes replied
+    TRACE_APDU_ERROR,     // state: instruction, offset: status word
+    TRACE_PARSE,          // state: AVM transaction parser state, offset: bytes consumed
+    TRACE_CODEC_FIELD,    // state: codec field kind, offset: bytes consumed
+    TRACE_RLP_ITEM,       // state: RLP item index, offset: bytes consumed
+    TRACE_PROMPT_FLUSH,   // state: prompts in the batch
+};
+
+#ifdef AVA_TRACE
+
+#define TRACE_RING_SIZE 32 // Power of two
+
+typedef struct {
+    uint8_t event;
+    uint8_t state;
+    uint16_t offset;
+    uint32_t tick;
+} trace_entry_t;
+
+typedef struct {
+    trace_entry_t entries[TRACE_RING_SIZE];
+    uint8_t head; // Index of the oldest entry
+    uint8_t count;
+    uint16_t dropped; // Entries overwritten before being drained
+    uint32_t volatile ticks; // Ticker events seen so far
+} trace_ring_t;
+
+_Static_assert((TRACE_RING_SIZE & (TRACE_RING_SIZE - 1)) == 0, "TRACE_RING_SIZE must be a power of two");
+
+extern trace_ring_t trace_ring;
+
+static inline void trace_record(uint8_t const event, uint8_t const state, uint16_t const offset) {
+    trace_entry_t *const entry = &trace_ring.entries[(trace_ring.head + trace_ring.count) & (TRACE_RING_SIZE - 1)];
+    if (trace_ring.count == TRACE_RING_SIZE) {
+        trace_ring.head = (trace_ring.head + 1) & (TRACE_RING_SIZE - 1);
+        trace_ring.dropped++;
+    } else {
+        trace_ring.count++;
+    }
+    entry->event = event;
+    entry->state = state;
+    entry->offset = offset;
+    entry->tick = trace_ring.ticks;
+}
+
+#define TRACE(event, state, offset) trace_record((event), (state), (offset))
+#define TRACE_TICK() (trace_ring.ticks++)
+
+#else
+
+#define TRACE(event, state, offset)
+#define TRACE_TICK()
+
+#endif
@@ -6,7 +6,10 @@
 #include "globals.h"
 #include "glyphs.h" // ui-menu
 #include "keys.h"
+#include "key_precompute.h"
 #include "memory.h"
+#include "profile.h"
+#include "trace.h"
 #include "os_cx.h" // ui-menu
 #include "to_string.h"
 
@@ -52,6 +55,9 @@ unsigned char io_event(__attribute__((unused)) unsigned char channel) {
         break;
 
     case SEPROXYHAL_TAG_TICKER_EVENT:
+        PROFILE_TICK();
+        TRACE_TICK();
+        precompute_key_tick();
         UX_TICKER_EVENT(G_io_seproxyhal_spi_buffer, {});
         break;
     }
@@ -227,6 +233,7 @@ void switch_screen(uint32_t which) {
     check_null(global.ui.prompt.callback_data[which]);
     global.ui.prompt.callbacks[which](global.ui.prompt.active_value, sizeof(global.ui.prompt.active_value),
                                       global.ui.prompt.callback_data[which]);
+    PROFILE_COUNT(PROFILE_TO_STRING);
 }
 
 void ui_prompt_debug(size_t screen_count) {
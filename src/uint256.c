@@ -340,6 +340,12 @@ void read_u64_be(uint8_t *in, uint64_t *out) {
 }
 
 void mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *target) {
+    mul256_overflow(number1, number2, target);
+}
+
+// Like __builtin_mul_overflow: target gets the truncated product, and true is
+// returned when the full product doesn't fit in 256 bits.
+bool mul256_overflow(const uint256_t *number1, const uint256_t *number2, uint256_t *target) {
     uint8_t num1[32], num2[32], result[64];
     memset(&result, 0, sizeof(result));
     for (uint8_t i = 0; i < 4; i++) {
@@ -350,6 +356,10 @@ void mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *targe
     for (uint8_t i = 0; i < 4; i++) {
         read_u64_be(result + 32 + i * sizeof(uint64_t), &target->elements[i / 2].elements[i % 2]);
     }
+    for (uint8_t i = 0; i < 32; i++) {
+        if (result[i] != 0) return true;
+    }
+    return false;
 }
 
 void divmod128(const uint128_t *l, const uint128_t *r, uint128_t *retDiv, uint128_t *retMod) {
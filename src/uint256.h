@@ -72,6 +72,7 @@ void or128(const uint128_t *number1, const uint128_t *number2, uint128_t *target
 void or256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
 void mul128(const uint128_t *number1, const uint128_t *number2, uint128_t *target);
 void mul256(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
+bool mul256_overflow(const uint256_t *number1, const uint256_t *number2, uint256_t *target);
 void divmod128(const uint128_t *l, const uint128_t *r, uint128_t *div, uint128_t *mod);
 void divmod256(const uint256_t *l, const uint256_t *r, uint256_t *div, uint256_t *mod);
 size_t tostring128(const uint128_t *number, size_t base, char *out, size_t outLength);
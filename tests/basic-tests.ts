@@ -27,6 +27,7 @@ import SpeculosTransport from '@ledgerhq/hw-transport-node-speculos';
 import Axios from 'axios';
 import Transport from "./transport";
 import Ava from "hw-app-avalanche";
+import createHash from "create-hash";
 
 describe("Basic Tests", () => {
   before( async function() {
@@ -163,61 +164,6 @@ describe("Basic Tests", () => {
 
     it('rejects signing hash when disallowed in settings', async function () {
       await deleteEvents();
-      let flipHashPolicy = async (target) => {
-        const setting = (called) => ({
-          "y": 17,
-          "text": called,
-          "actions": called === target
-            ? pressAndReleaseSingleButton(2)
-            : pressAndReleaseBothButtons,
-        });
-        await setAutomationRules([
-          setting("Allow"),
-          setting("Allow with warning"),
-          setting("Disallow"),
-          {
-            "y": 3,
-            "text": "Sign hash policy",
-            "actions": [], // wait for the policy
-          },
-          {
-            "text": "Configuration",
-            "actions": pressAndReleaseBothButtons,
-          },
-          {
-            "text": "Main menu",
-            "actions": pressAndReleaseBothButtons,
-          },
-          {
-            "text": "Avalanche",
-            "actions": [], // we made it home!
-          },
-          {
-            "y": 17,
-            "actions": []
-          },
-          {
-            // wild card, match any screen if we get this far
-            "actions": pressAndReleaseSingleButton(2),
-          },
-        ]);
-        await Axios.post(`${baseUrl}/button/right`, {"action":"press-and-release"});
-        const doneEvents = [
-          {"text": "Main menu", "x": 33, "y": 3},
-          {"text": "Avalanche", "x": 34, "y": 3},
-          {"text": APP_VERSION, "x": 52, "y": 17},
-        ];
-        // Don't know how to do any better than polling :(
-        while (true) {
-          const events = (await getEvents()).slice(-3);
-          //console.log(events);
-          try {
-            expect(events).to.deep.equal(doneEvents);
-            break;
-          } catch {
-          }
-        }
-      };
       let ava = await makeAva();
       await flipHashPolicy("Disallow");
 
@@ -237,6 +183,26 @@ describe("Basic Tests", () => {
       }
     });
 
+    it('rejects EIP-712 hashes when hash signing is disallowed in settings', async function () {
+      await deleteEvents();
+      let ava = await makeAva();
+      await flipHashPolicy("Disallow");
+
+      try {
+        // EIP-712 typed data is only shown as hashes, so it is blind signing too
+        await ava.transport.send(0xe0, 0x0c, 0x00, 0x00, Buffer.concat([
+          Buffer.from('058000002c8000003c800000000000000000000000', 'hex'),
+          Buffer.alloc(64, 0x11),
+        ]));
+        throw "Expected failure";
+      } catch (e) {
+        expect(e).has.property('statusCode', 0x6985); // REJECT
+      } finally {
+        await flipHashPolicy("Allow with warning");
+        await setAutomationRules([]);
+      }
+    });
+
     it('can sign a transaction based on the serialization reference in verbose mode', async function () {
       const txn = buildTransaction();
 
@@ -594,6 +560,35 @@ describe("Basic Tests", () => {
        prompts,
      );
     });
+
+    it('previews a transaction without prompting', async function () {
+      const txn = buildTransaction();
+      const summary = await previewTransaction(txn);
+
+      expect(summary.readUInt32BE(0)).to.equal(0); // base transaction
+      expect(summary.readUInt8(4)).to.equal(0); // X-chain
+      expect(summary.readBigUInt64BE(5)).to.equal(BigInt(123456789)); // sum of inputs
+      expect(summary.readBigUInt64BE(13)).to.equal(BigInt(12345)); // sum of outputs
+      expect(summary.readBigUInt64BE(21)).to.equal(BigInt(123444444)); // fee
+      expect(summary.readBigUInt64BE(29)).to.equal(BigInt(0)); // staked
+      expect(summary.slice(37).toString('hex')).to.equal(createHash('sha256').update(txn).digest('hex'));
+    });
+
+    it('rejects unsupported asset IDs in preview without prompting', async function () {
+      const assetId = Buffer.from([
+        0x3d, 0x9b, 0xda, 0xc0, 0xed, 0x1d, 0x76, 0x13,
+        0x30, 0xcf, 0x68, 0x0e, 0xfd, 0xeb, 0x1a, 0x42,
+        0x15, 0x9e, 0xb3, 0x87, 0xd6, 0xd2, 0x95, 0x0c,
+        0x96, 0xf7, 0xd2, 0x8f, 0x61, 0xbb, 0xe2, 0xab, // fuji AVAX assetID, except last byte is wrong
+      ]);
+      try {
+        await previewTransaction(buildTransaction({ inputAssetId: assetId, outputAssetId: assetId }));
+        throw "Preview should have been rejected";
+      } catch (e) {
+        expect(e).has.property('statusCode', 0x9405); // PARSE_ERROR
+        expect(e).has.property('statusText', 'UNKNOWN_ERROR');
+      }
+    });
   });
 
 
@@ -875,6 +870,79 @@ async function signTransaction(
   );
 }
 
+// Sets the sign hash policy through the settings menu and waits to be back home.
+async function flipHashPolicy(target: string) {
+  const setting = (called) => ({
+    "y": 17,
+    "text": called,
+    "actions": called === target
+      ? pressAndReleaseSingleButton(2)
+      : pressAndReleaseBothButtons,
+  });
+  await setAutomationRules([
+    setting("Allow"),
+    setting("Allow with warning"),
+    setting("Disallow"),
+    {
+      "y": 3,
+      "text": "Sign hash policy",
+      "actions": [], // wait for the policy
+    },
+    {
+      "text": "Configuration",
+      "actions": pressAndReleaseBothButtons,
+    },
+    {
+      "text": "Main menu",
+      "actions": pressAndReleaseBothButtons,
+    },
+    {
+      "text": "Avalanche",
+      "actions": [], // we made it home!
+    },
+    {
+      "y": 17,
+      "actions": []
+    },
+    {
+      // wild card, match any screen if we get this far
+      "actions": pressAndReleaseSingleButton(2),
+    },
+  ]);
+  await Axios.post(`${baseUrl}/button/right`, {"action":"press-and-release"});
+  const doneEvents = [
+    {"text": "Main menu", "x": 33, "y": 3},
+    {"text": "Avalanche", "x": 34, "y": 3},
+    {"text": APP_VERSION, "x": 52, "y": 17},
+  ];
+  // Don't know how to do any better than polling :(
+  while (true) {
+    const events = (await getEvents()).slice(-3);
+    //console.log(events);
+    try {
+      expect(events).to.deep.equal(doneEvents);
+      break;
+    } catch {
+    }
+  }
+}
+
+const INS_PREVIEW_TRANSACTION = 0x06;
+
+async function previewTransaction(txn: Buffer): Promise<Buffer> {
+  const transport = await transportOpen();
+  const ava = new Ava(transport);
+  const chunkSize = 230;
+
+  await transport.send(ava.CLA, INS_PREVIEW_TRANSACTION, 0x00, 0x00, Buffer.alloc(0));
+  let response: Buffer;
+  for (let i = 0; i < txn.length; i += chunkSize) {
+    const isLast = i + chunkSize >= txn.length;
+    response = await transport.send(ava.CLA, INS_PREVIEW_TRANSACTION, isLast ? 0x81 : 0x01, 0x00, txn.slice(i, i + chunkSize));
+  }
+  return response.slice(0, -2);
+}
+
 //async function expectSignFailure(speculos, ava, fields, prompts=undefined) {
 async function expectSignFailure(fields: FieldOverrides, prompts: Screen[] = undefined) {
   try {
@@ -8,6 +8,7 @@ export { default as BIPPath } from "bip32-path";
 import { default as BIPPath } from "bip32-path";
 import secp256k1 from 'bcrypto/lib/secp256k1';
 import Transport from "./transport";
+import BaseTransport from "@ledgerhq/hw-transport";
 import Ava from "hw-app-avalanche";
 import Axios from 'axios';
 export const { recover } = secp256k1;
@@ -314,3 +315,102 @@ export const signHashPrompts = (hash: string, pathPrefix: BIPPath): Screen[] =>
 };
 
 export const finalizePrompt: Screen = {header: "Finalize", body: "Transaction"};
+
+// Debug instructions of TRACE=1 and PARSE_STATS=1 builds (see src/trace.h and src/parse_stats.h).
+export const traceBuild = (process.env.TRACE || '0') !== '0';
+export const parseStatsBuild = (process.env.PARSE_STATS || '0') !== '0';
+
+export const INS_TRACE_DRAIN = 0x09;
+export const INS_PARSE_STATS = 0x0a;
+
+const AVA_CLA = 0x80;
+const TRACE_ENTRY_SIZE = 8;
+const TRACE_ENTRIES_PER_REPLY = Math.floor((260 - 5) / TRACE_ENTRY_SIZE); // What fits in a reply
+
+export const traceEvents: { [id: number]: string } = {
+  1: "APDU_BEGIN",
+  2: "APDU_END",
+  3: "APDU_ERROR",
+  4: "PARSE",
+  5: "CODEC_FIELD",
+  6: "RLP_ITEM",
+  7: "PROMPT_FLUSH",
+};
+
+export interface TraceEntry {
+  event: string;
+  state: number;
+  offset: number;
+  tick: number;
+}
+
+export interface TraceChunk {
+  dropped: number;
+  entries: TraceEntry[];
+}
+
+// Decodes one trace drain response, without its status word.
+export const decodeTrace = (buf: Buffer): TraceChunk => {
+  const dropped = buf.readUInt16BE(0);
+  const count = buf.readUInt8(2);
+  const entries: TraceEntry[] = [];
+  for (let i = 0; i < count; i++) {
+    const at = 3 + i * TRACE_ENTRY_SIZE;
+    const id = buf.readUInt8(at);
+    entries.push({
+      event: traceEvents[id] || `UNKNOWN_${id}`,
+      state: buf.readUInt8(at + 1),
+      offset: buf.readUInt16BE(at + 2),
+      tick: buf.readUInt32BE(at + 4),
+    });
+  }
+  return { dropped, entries };
+};
+
+const isTraceDrainEvent = (e: TraceEntry): boolean =>
+  ["APDU_BEGIN", "APDU_END", "APDU_ERROR"].includes(e.event) && e.state === INS_TRACE_DRAIN;
+
+// Drains the device's trace buffer, oldest entry first. Every drain records
+// its own APDU, so the buffer never empties: stop at the first reply that
+// isn't full, and leave the drain's own events out.
+export const drainTrace = async (transport: BaseTransport): Promise<TraceChunk> => {
+  const result: TraceChunk = { dropped: 0, entries: [] };
+  while (true) {
+    const response = await transport.send(AVA_CLA, INS_TRACE_DRAIN, 0x00, 0x00, Buffer.alloc(0));
+    const chunk = decodeTrace(response.slice(0, -2));
+    result.dropped += chunk.dropped;
+    result.entries.push(...chunk.entries.filter(e => !isTraceDrainEvent(e)));
+    if (chunk.entries.length < TRACE_ENTRIES_PER_REPLY) return result;
+  }
+};
+
+export const formatTrace = (trace: TraceChunk): string =>
+  (trace.dropped > 0 ? `(${trace.dropped} entries dropped)\n` : "") +
+  trace.entries.map(e => `${e.tick}\t${e.event}\tstate=${e.state}\toffset=${e.offset}`).join("\n");
+
+export interface ParseStats {
+  chunks: number;
+  minChunk: number;
+  maxChunk: number;
+  bytes: number;
+  promptFlushes: number;
+  needMore: number;
+  resumes: number;
+}
+
+// Decodes a parse stats response, without its status word.
+export const decodeParseStats = (buf: Buffer): ParseStats => ({
+  chunks: buf.readUInt16BE(0),
+  minChunk: buf.readUInt16BE(2),
+  maxChunk: buf.readUInt16BE(4),
+  bytes: buf.readUInt32BE(6),
+  promptFlushes: buf.readUInt16BE(10),
+  needMore: buf.readUInt16BE(12),
+  resumes: buf.readUInt16BE(14),
+});
+
+// Reads the counters of the last signing or preview session that finished.
+export const readParseStats = async (transport: BaseTransport): Promise<ParseStats> => {
+  const response = await transport.send(AVA_CLA, INS_PARSE_STATS, 0x00, 0x00, Buffer.alloc(0));
+  return decodeParseStats(response.slice(0, -2));
+};
@@ -9,17 +9,23 @@ import {
   processPrompts,
   getEvents,
   Screen,
+  traceBuild,
+  drainTrace,
+  parseStatsBuild,
+  readParseStats,
 } from "./common";
 
 import Eth from '@ledgerhq/hw-app-eth';
 import { Transaction } from "@ethereumjs/tx";
-import { FeeMarketEIP1559Transaction as EIP1559Transaction } from "@ethereumjs/tx";
+import { FeeMarketEIP1559Transaction as EIP1559Transaction, AccessListEIP2930Transaction as EIP2930Transaction } from "@ethereumjs/tx";
 import Common from "@ethereumjs/common";
 import { BN } from "bn.js";
-import { bnToRlp, rlp } from "ethereumjs-util";
+import { bnToRlp, rlp, ecrecover, hashPersonalMessage, keccak256 } from "ethereumjs-util";
 import { decode } from "rlp";
 import { byContractAddressAndChainId } from "@ledgerhq/hw-app-eth/erc20";
 import erc20presetMinterPauser from "./ERC20PresetMinterPauser";
+import secp256k1 from 'bcrypto/lib/secp256k1';
+import createHash from "create-hash";
 
 const rawUnsignedLegacyTransaction = (chainId, unsignedTxParams) => {
     const common = Common.forCustomChain(1, { name: 'avalanche', networkId: 1, chainId });
@@ -55,6 +61,12 @@ const rawUnsignedEIP1559Transaction = (chainId, unsignedTxParams) => {
   return unsignedTx.getMessageToSign(false);
 };
 
+const rawUnsignedEIP2930Transaction = (chainId, unsignedTxParams) => {
+  const common = Common.forCustomChain(1, { name: 'avalanche', networkId: 1, chainId }, 'berlin');
+  const unsignedTx = EIP2930Transaction.fromTxData({...unsignedTxParams}, { common });
+  return unsignedTx.getMessageToSign(false);
+};
+
 const transferPrompts = (address, amount, fee) => chunkPrompts([
   {header: "Transfer",    body: amount + " to " + address},
   {header: "Fee",          body: fee},
@@ -78,16 +90,24 @@ const contractCallPrompts = (method, argumentPrompts) => {
        .concat([finalizePrompt]);
 };
 
-const contractDeployPrompts = (amount, fee, gas) => {
+// Nano X and Nano S Plus builds also show a digest of the whole init code.
+const evmDataHash = (process.env.EVM_DATA_HASH || '0') !== '0';
+
+const contractDeployPrompts = (amount, fee, gas, initCode: Buffer) => {
   const creationPrompt = {header: "Contract",          body: "Creation"};
   const gasPrompt      = {header: "Gas Limit",         body: gas};
   const fundingPrompt  = {header: "Funding Contract",  body: amount};
-  const dataPrompt     = {header: "Data",              body: "0x60806040523480156200001157600080fd5b5060..."};
+  const dataPrompt     = {header: "Data",              body: "0x" + initCode.slice(0, 20).toString('hex') + "..."};
+  const hashPrompt     = {header: "Init Code Hash",    body: "0x" + keccak256(initCode).toString('hex')};
   const feePrompt      = {header: "Maximum Fee",       body: fee};
-  return chunkPrompts(amount
-    ? [creationPrompt, gasPrompt, fundingPrompt, dataPrompt, feePrompt]
-    : [creationPrompt, gasPrompt, dataPrompt, feePrompt]
-  )
+  return chunkPrompts([
+    creationPrompt,
+    gasPrompt,
+    ...(amount ? [fundingPrompt] : []),
+    dataPrompt,
+    ...(evmDataHash ? [hashPrompt] : []),
+    feePrompt,
+  ])
     .concat([finalizePrompt]);
 };
 
@@ -161,7 +181,7 @@ async function testLegacySigning(self, chainId, prompts, hexTx) {
   expect(ethTxObj.getSenderPublicKey()).to.equalBytes("ef5b152e3f15eb0c50c9916161c2309e54bd87b9adce722d69716bcdef85f547678e15ab40a78919c7284e67a17ee9a96e8b9886b60f767d93023bac8dbc16e4");
 }
 
-async function testEIP1559Signing(self, chainId, prompts: Screen[], hexTx) {
+async function testEIP1559Signing(self, chainId, prompts: Screen[], hexTx, TxType: any = EIP1559Transaction) {
   const ethTx = Buffer.from(hexTx, 'hex');
 
   const dat = await sendCommandAndAccept(async (eth : Eth) => {
@@ -169,22 +189,103 @@ async function testEIP1559Signing(self, chainId, prompts: Screen[], hexTx) {
     return await eth.signTransaction("44'/60'/0'/0/0", hexTx, resolution);
   }, prompts);
   const chain = Common.forCustomChain(1, { name: 'avalanche', networkId: 1, chainId }, 'london')
-  // remove the first byte from the start of the ethtx, the transactionType that's indicating it's an eip1559 transaction
+  // remove the first byte from the start of the ethtx, the transactionType that's indicating it's an eip1559 (or eip2930) transaction
   const txnBufsDecoded: any = decode(ethTx.slice(1)).slice(0,9);
   const txnBufsMap = [dat.v, dat.r, dat.s].map(a=>Buffer.from(((a.length%2==1)?'0'+a:a),'hex'))
   const txnBufs = txnBufsDecoded.concat(txnBufsMap);
-  const ethTxObj = EIP1559Transaction.fromValuesArray(txnBufs, {common: chain});
+  const ethTxObj = TxType.fromValuesArray(txnBufs, {common: chain});
   expect(ethTxObj.verifySignature()).to.equal(true);
   expect(ethTxObj.getSenderPublicKey()).to.equalBytes("ef5b152e3f15eb0c50c9916161c2309e54bd87b9adce722d69716bcdef85f547678e15ab40a78919c7284e67a17ee9a96e8b9886b60f767d93023bac8dbc16e4");
 }
 
+const expectSignedBySpeculosKey = (hash: Buffer, dat) => {
+  expect(dat.v).to.be.oneOf([27, 28]);
+  const publicKey = ecrecover(hash, dat.v, Buffer.from(dat.r, 'hex'), Buffer.from(dat.s, 'hex'));
+  expect(publicKey).to.equalBytes("ef5b152e3f15eb0c50c9916161c2309e54bd87b9adce722d69716bcdef85f547678e15ab40a78919c7284e67a17ee9a96e8b9886b60f767d93023bac8dbc16e4");
+};
+
+const testPersonalMessage = (message: Buffer, preview: string) => async function () {
+  const dat = await sendCommandAndAccept(async (eth : Eth) => {
+    return await eth.signPersonalMessage("44'/60'/0'/0/0", message.toString('hex'));
+  }, [
+    {header: "Sign",    body: "Personal Message"},
+    {header: "Message", body: preview},
+  ]);
+  expectSignedBySpeculosKey(hashPersonalMessage(message), dat);
+};
+
+const eip712Hash = (domainSeparator: Buffer, messageHash: Buffer): Buffer =>
+  keccak256(Buffer.concat([Buffer.from('1901', 'hex'), domainSeparator, messageHash]));
+
+const word = (hex: string): Buffer => Buffer.from(hex.padStart(64, '0'), 'hex');
+
+// An EIP-2612 permit for USDC on the C-chain
+const permitDomain = {
+  chainId: 43114,
+  verifyingContract: 'b97ef9ef8734c71904d8002f8b6bc66dd9c48a6e',
+  fields: Buffer.concat([
+    Buffer.from([8]), Buffer.from('USD Coin'),
+    keccak256(Buffer.from('2')),
+    word((43114).toString(16)),
+    Buffer.from('b97ef9ef8734c71904d8002f8b6bc66dd9c48a6e', 'hex'),
+  ]),
+};
+const permitDomainSeparator = keccak256(Buffer.concat([
+  keccak256(Buffer.from('EIP712Domain(string name,string version,uint256 chainId,address verifyingContract)')),
+  keccak256(Buffer.from('USD Coin')),
+  keccak256(Buffer.from('2')),
+  word((43114).toString(16)),
+  word(permitDomain.verifyingContract),
+]));
+const permitMessage = Buffer.concat([
+  keccak256(Buffer.from('Permit(address owner,address spender,uint256 value,uint256 nonce,uint256 deadline)')),
+  word('41f52d6fc4a0f5fa24fd3a9af1b5e6ea0b2e2e4b'),
+  word('0101020203030404050506060707080809090a0a'),
+  word('0f4240'),
+  word('00'),
+  word('ffffffff'),
+]);
+
+// Descriptors are checked against a test key in CAL_TEST_KEY=1 builds, whose private key this is.
+const calTestKey = (process.env.CAL_TEST_KEY || '0') !== '0';
+const calTestPrivateKey = Buffer.from('db4f1aa1acafacd0f114f8b482631a1201f95993536d03dcd26bfaa5389068a8', 'hex');
+
+const erc20Contract = 'b97ef9ef8734c71904d8002f8b6bc66dd9c48a6e';
+const erc20Descriptor = (chainIdHex: string, signingKey: Buffer = calTestPrivateKey): Buffer => {
+  const ticker = Buffer.from('TKN', 'ascii');
+  const signed = Buffer.concat([
+    ticker,
+    Buffer.from(erc20Contract, 'hex'),
+    Buffer.from('00000006', 'hex'), // decimals
+    Buffer.from(chainIdHex, 'hex'),
+  ]);
+  const hash = createHash('sha256').update(signed).digest();
+  return Buffer.concat([Buffer.from([ticker.length]), signed, secp256k1.signDER(hash, signingKey)]);
+};
+
+// Collected from a metamask goerli transaction:
+const metamaskDeployTx = Buffer.from('02f9018a82a868808506fc23ac008506fc23ac008316e3608080b90170608060405234801561001057600080fd5b50610150806100206000396000f3fe608060405234801561001057600080fd5b50600436106100365760003560e01c80632e64cec11461003b5780636057361d14610059575b600080fd5b610043610075565b60405161005091906100d9565b60405180910390f35b610073600480360381019061006e919061009d565b61007e565b005b60008054905090565b8060008190555050565b60008135905061009781610103565b92915050565b6000602082840312156100b3576100b26100fe565b5b60006100c184828501610088565b91505092915050565b6100d3816100f4565b82525050565b60006020820190506100ee60008301846100ca565b92915050565b6000819050919050565b600080fd5b61010c816100f4565b811461011757600080fd5b5056fea2646970667358221220404e37f487a89a932dca5e77faaf6ca2de3b991f93d230604b1b8daaef64766264736f6c63430008070033c0', 'hex');
+const metamaskDeployPrompts = () => contractDeployPrompts(null, '90000000 GWEI', '1500000', decode(metamaskDeployTx.slice(1))[7] as any);
+
+// Sends a transaction to sign in APDUs carrying chunkSize bytes of it, and
+// returns the last reply.
+const signEvmTransactionInChunks = async (transport, tx: Buffer, chunkSize: number): Promise<Buffer> => {
+  const path = Buffer.from('058000002c8000003c800000000000000000000000', 'hex');
+  let rv;
+  for (let i = 0; i < tx.length; i += chunkSize) {
+    const chunk = tx.slice(i, i + chunkSize);
+    rv = await transport.send(0xe0, 0x04, i == 0 ? 0x00 : 0x80, 0x00, i == 0 ? Buffer.concat([path, chunk]) : chunk);
+  }
+  return rv;
+};
+
 const testDeploy = (chainId, withAmount) => async function () {
     this.timeout(8000);
     const [amountPrompt, amountHex] = withAmount
       ? ['0.000000001 nAVAX', '01']
       : [null, '80'];
     await testLegacySigning(this, chainId,
-      contractDeployPrompts(amountPrompt, '1428785900 GWEI', '3039970'),
+      contractDeployPrompts(amountPrompt, '1428785900 GWEI', '3039970', Buffer.from(erc20presetMinterPauser.bytecodeHex, 'hex')),
       ('f93873' + '03' + '856d6e2edc00' + '832e62e2' + '80' + amountHex
        + ('b9385e' + erc20presetMinterPauser.bytecodeHex)
        + '82a868' + '80' + '80'
@@ -338,19 +439,130 @@ describe("Eth app compatibility tests", async function () {
       await testEIP1559Signing(this, chainId, prompts, tx);
     });
 
+    it('can sign an EIP1559 transaction with an access list', async function() {
+      const chainId = 43112;
+      const tx = rawUnsignedEIP1559Transaction(chainId, {
+          nonce: '0x0a',
+          maxFeePerGas: '0x3400',
+          maxPriorityFeePerGas: '0x' + '64',
+          gasLimit: '0x' + 'ab',
+          to: '0x' + '0102030400000000000000000000000000000002',
+          value: '0x' + '1000',
+          accessList: [
+            {
+              address: '0x' + '0102030400000000000000000000000000000002',
+              storageKeys: ['0x' + '01'.padStart(64, '0'), '0x' + '02'.padStart(64, '0')],
+            },
+            {
+              address: '0x' + '28ee52a8f3d6e5d15f8b131996950d7f296c7952',
+              storageKeys: ['0x' + '03'.padStart(64, '0')],
+            },
+          ],
+      });
+
+      const transferPrompt = {header: "Transfer",     body: '0.000004096 nAVAX' + " to " + '0x' + '0102030400000000000000000000000000000002'};
+      const feePrompt = {header: "Fee",   body: "0.002293452 GWEI"};
+      const accessListPrompt = {header: "Access List", body: "2 addresses, 3 storage keys"};
+      const prompts = chunkPrompts([transferPrompt, feePrompt, accessListPrompt])
+        .concat([finalizePrompt]);
+
+      await testEIP1559Signing(this, chainId, prompts, tx);
+    });
+
+    it('can sign an EIP2930 transaction with an access list', async function() {
+      const chainId = 43112;
+      const tx = rawUnsignedEIP2930Transaction(chainId, {
+          nonce: '0x0a',
+          gasPrice: '0x3400',
+          gasLimit: '0x' + 'ab',
+          to: '0x' + '0102030400000000000000000000000000000002',
+          value: '0x' + '1000',
+          accessList: [
+            {
+              address: '0x' + '0102030400000000000000000000000000000002',
+              storageKeys: ['0x' + '01'.padStart(64, '0'), '0x' + '02'.padStart(64, '0')],
+            },
+            {
+              address: '0x' + '28ee52a8f3d6e5d15f8b131996950d7f296c7952',
+              storageKeys: ['0x' + '03'.padStart(64, '0')],
+            },
+          ],
+      });
+
+      const transferPrompt = {header: "Transfer",     body: '0.000004096 nAVAX' + " to " + '0x' + '0102030400000000000000000000000000000002'};
+      const feePrompt = {header: "Fee",   body: "0.002276352 GWEI"};
+      const accessListPrompt = {header: "Access List", body: "2 addresses, 3 storage keys"};
+      const prompts = chunkPrompts([transferPrompt, feePrompt, accessListPrompt])
+        .concat([finalizePrompt]);
+
+      await testEIP1559Signing(this, chainId, prompts, tx, EIP2930Transaction);
+    });
+
   it('Can sign an eip1559 transaction collected from metamask', async function() {
     this.timeout(8000);
-    const chainId = 43112;
-    // Collected from a metamask goerli transaction:
-    const tx = Buffer.from('02f9018a82a868808506fc23ac008506fc23ac008316e3608080b90170608060405234801561001057600080fd5b50610150806100206000396000f3fe608060405234801561001057600080fd5b50600436106100365760003560e01c80632e64cec11461003b5780636057361d14610059575b600080fd5b610043610075565b60405161005091906100d9565b60405180910390f35b610073600480360381019061006e919061009d565b61007e565b005b60008054905090565b8060008190555050565b60008135905061009781610103565b92915050565b6000602082840312156100b3576100b26100fe565b5b60006100c184828501610088565b91505092915050565b6100d3816100f4565b82525050565b60006020820190506100ee60008301846100ca565b92915050565b6000819050919050565b600080fd5b61010c816100f4565b811461011757600080fd5b5056fea2646970667358221220404e37f487a89a932dca5e77faaf6ca2de3b991f93d230604b1b8daaef64766264736f6c63430008070033c0', 'hex');
-
-    const contractCreationPrompt = { header: 'Contract', body: 'Creation' };
-    const gasLimitPrompt = { header: 'Gas Limit', body: '1500000' };
-    const dataPrompt = { header: 'Data', body: '0x608060405234801561001057600080fd5b506101...' };
-    const maxFeePrompt = { header: 'Maximum Fee', body: '90000000 GWEI' };
-    const prompts = chunkPrompts([contractCreationPrompt, gasLimitPrompt, dataPrompt, maxFeePrompt])
-      .concat([finalizePrompt]);
-    await testEIP1559Signing(this, chainId, prompts, tx);
+    await testEIP1559Signing(this, 43112, metamaskDeployPrompts(), metamaskDeployTx.toString('hex'));
+  });
+
+  it('shows the same deploy prompts and signature however the transaction is split into apdus', async function () {
+    this.timeout(60000);
+    const transport = await transportOpen();
+    let signature = null;
+    for (const chunkSize of [1, 2, 3, 7, 64, 150]) {
+      await setAcceptAutomationRules();
+      await deleteEvents();
+      const rv = await signEvmTransactionInChunks(transport, metamaskDeployTx, chunkSize);
+      expect(processPrompts(await getEvents())).to.deep.equal(metamaskDeployPrompts());
+      if (signature == null) signature = rv;
+      expect(rv).to.equalBytes(signature);
+    }
+  });
+
+  it('traces the RLP items of a signed transaction', async function () {
+    if (!traceBuild) this.skip();
+    const transport = await transportOpen();
+    await drainTrace(transport);
+    const tx = 'ed01856d6e2edc008252089428ee52a8f3d6e5d15f8b131996950d7f296c7952872bd72a248740008082a86a8080';
+    await testLegacySigning(this, 43114,
+      transferPrompts('0x28ee52a8f3d6e5d15f8b131996950d7f296c7952', '0.01234 AVAX', '9870000 GWEI'),
+      tx);
+    const trace = await drainTrace(transport);
+    expect(trace.dropped).to.equal(0);
+    // One APDU: header, path and transaction
+    expect(trace.entries.filter(e => e.event == "APDU_BEGIN").map(e => [e.state, e.offset])).to.deep.equal([
+      [0x04, 5 + 21 + tx.length / 2],
+    ]);
+    // Offsets are input consumed when each item finishes
+    expect(trace.entries.filter(e => e.event == "RLP_ITEM").map(e => [e.state, e.offset])).to.deep.equal([
+      [0, 2], [1, 8], [2, 11], [3, 32], [4, 40], [5, 41], [6, 44], [7, 45], [8, 46],
+    ]);
+    // Transfer and Fee
+    expect(trace.entries.filter(e => e.event == "PROMPT_FLUSH").reduce((n, e) => n + e.state, 0)).to.equal(2);
+  });
+
+  it('counts the chunks and prompt batches of a signed transaction', async function () {
+    if (!parseStatsBuild) this.skip();
+    this.timeout(20000);
+    const transport = await transportOpen();
+    const chunkSize = 64;
+    const prompts = metamaskDeployPrompts();
+    await setAcceptAutomationRules();
+    await deleteEvents();
+    await signEvmTransactionInChunks(transport, metamaskDeployTx, chunkSize);
+    expect(processPrompts(await getEvents())).to.deep.equal(prompts);
+
+    const stats = await readParseStats(transport);
+    const chunks = Math.ceil(metamaskDeployTx.length / chunkSize);
+    const batches = prompts.filter(p => p.header == "Next").length;
+    expect(stats).to.deep.include({
+      chunks,
+      minChunk: metamaskDeployTx.length % chunkSize || chunkSize,
+      maxChunk: chunkSize,
+      bytes: metamaskDeployTx.length,
+      needMore: chunks - 1,
+      resumes: batches,
+    });
+    // The last batch is flushed when the parser is done rather than by a PROMPT return
+    expect(stats.promptFlushes).to.be.within(batches - 1, batches);
   });
 
   it('A call to assetCall with incorrect call data rejects', async function() {
@@ -372,6 +584,17 @@ describe("Eth app compatibility tests", async function () {
      testUnrecognizedCalldata('90000102030405060708090a0b0c0d0e0f')
     );
 
+  it('can sign unrecognized calldata with the full C-chain gas limit',
+     testUnrecognizedCalldataTx(
+       43112,
+       '34630b8a00',
+       '05f5e100',
+       "0.000000001 nAVAX", '01',
+       "0102030400000000000000000000000000000002",
+       '22500000000 GWEI',
+       'abcdef01')
+    );
+
   it('can sign unrecognized calldata (borrow)',
      testUnrecognizedCalldata('a415bcad000000000000000000000000d3896bdd73e61a4275e27f660ddf095522f0a1d30000000000000000000000000000000000000000000000000de0b6b3a7640000000000000000000000000000000000000000000000000000000000000000000200000000000000000000000000000000000000000000000000000000000000000000000000000000000000006f0f6da1852857d7789f68a28bba866671f3880d')
     );
@@ -415,6 +638,36 @@ describe("Eth app compatibility tests", async function () {
     { header: "account", body: '0x' + testData.address.prompt },
   ]));
 
+  it('can sign a WAVAX deposit contract call', testCall(43113, 'd0e30db0', 'deposit', []));
+  it('can sign a WAVAX withdraw contract call', testCall(43113, '2e1a7d4d' + testData.amount.hex, 'withdraw', [
+    { header: "wad", body: testData.amount.prompt },
+  ]));
+
+  it('can sign a router swap with an address[] path', testCall(43113,
+    '38ed1739' + testData.amount.hex + testData.amount.hex + word('a0').toString('hex') + testData.address.hex + word('65f0a1b0').toString('hex')
+    + word('02').toString('hex') + testData.address.hex + testData.address.hex,
+    'swapExactTokensForTokens', [
+    { header: "amountIn",     body: testData.amount.prompt },
+    { header: "amountOutMin", body: testData.amount.prompt },
+    { header: "to",           body: '0x' + testData.address.prompt },
+    { header: "deadline",     body: '1710268848' },
+    { header: "path",         body: '0x' + testData.address.prompt },
+    { header: "path",         body: '0x' + testData.address.prompt },
+  ]));
+
+  const transferCall = 'a9059cbb' + testData.address.hex + testData.amount.hex;
+  it('can sign a multicall, previewing each bytes[] element', testCall(43113,
+    '5ae401dc' + word('65f0a1b0').toString('hex') + word('40').toString('hex')
+    + word('02').toString('hex') + word('40').toString('hex') + word('c0').toString('hex')
+    + word('44').toString('hex') + transferCall.padEnd(192, '0')
+    + word('04').toString('hex') + '12345678'.padEnd(64, '0'),
+    'multicall', [
+    { header: "deadline", body: '1710268848' },
+    { header: "data",     body: '0x' + transferCall.slice(0, 48) + '... (68 bytes'
+      + (evmDataHash ? ', Keccak 0x' + keccak256(Buffer.from(transferCall, 'hex')).toString('hex') : '') + ')' },
+    { header: "data",     body: '0x12345678' },
+  ]));
+
   it('can sign a transaction deploying erc20 contract without funding', testDeploy(43112, false));
   it('can sign a transaction deploying erc20 contract with funding',    testDeploy(43112, true));
 
@@ -440,7 +693,7 @@ describe("Eth app compatibility tests", async function () {
 
   it('can provide an ERC20 Token and sign with the ethereum ledgerjs module', async function() {
     const zrxInfo = byContractAddressAndChainId("0xe41d2489571d322189246dafa5ebde1f4699f498", 43114);
-    if (zrxInfo !== undefined)
+    if (zrxInfo !== undefined && !calTestKey)
     {
       const result = await this.eth.provideERC20TokenInformation(zrxInfo);
     }
@@ -454,6 +707,97 @@ describe("Eth app compatibility tests", async function () {
     );
   });
 
+  it('rejects ERC20 token information not signed by the crypto asset list', async function() {
+    try {
+      await this.eth.provideERC20TokenInformation({ data: erc20Descriptor('0000a869', Buffer.alloc(32, 0x42)) });
+      throw "Expected failure";
+    } catch (e) {
+      expect(e).has.property('statusCode', 0x6982); // SECURITY_STATUS_NOT_SATISFIED
+    }
+  });
+
+  it('renders ERC20 amounts with provided token information', async function() {
+    if (!calTestKey) this.skip();
+    await this.eth.provideERC20TokenInformation({ data: erc20Descriptor('0000a869') });
+
+    const tx = rawUnsignedLegacyTransaction(43113, {
+        nonce: '0x0a',
+        gasPrice: '0x34630b8a00',
+        gasLimit: '0xb197',
+        to: '0x' + erc20Contract,
+        value: '0x0',
+        data: '0xa9059cbb' + testData.address.hex + testData.amount.hex,
+    });
+    await testLegacySigning(this, 43113, contractCallPrompts('transfer', [
+      { header: "recipient", body: '0x' + testData.address.prompt },
+      { header: "amount",    body: '0.00017 TKN' },
+    ]), tx);
+  });
+
+  it('rejects ERC20 token information for another chain', async function() {
+    if (!calTestKey) this.skip();
+    await this.eth.provideERC20TokenInformation({ data: erc20Descriptor('0000a86a') });
+
+    const tx = rawUnsignedLegacyTransaction(43113, {
+        nonce: '0x0a',
+        gasPrice: '0x34630b8a00',
+        gasLimit: '0xb197',
+        to: '0x' + erc20Contract,
+        value: '0x0',
+        data: '0xa9059cbb' + testData.address.hex + testData.amount.hex,
+    });
+    try {
+      await sendCommand(async (eth: Eth) => await eth.signTransaction("44'/60'/0'/0/0", tx.toString('hex'), null));
+      throw "Signing should have been rejected";
+    } catch (e) {
+      expect(e).has.property('statusCode', 0x9405); // PARSE_ERROR
+    }
+  });
+
+  it('can sign a personal message', testPersonalMessage(
+    Buffer.from("Sign in to Avalanche\nNonce: 42", 'ascii'),
+    "Sign in to Avalanche Nonce: 42"));
+
+  it('can sign a long binary personal message across several apdus', testPersonalMessage(
+    Buffer.from(Array.from({length: 400}, (_, i) => i % 256)),
+    "0x" + Buffer.from(Array.from({length: 64}, (_, i) => i)).toString('hex') + "..."));
+
+  it('can sign EIP-712 typed data from its hashes', async function () {
+    const messageHash = keccak256(permitMessage);
+    const dat = await sendCommandAndAccept(async (eth : Eth) => {
+      return await eth.signEIP712HashedMessage("44'/60'/0'/0/0", permitDomainSeparator.toString('hex'), messageHash.toString('hex'));
+    }, [
+      {header: "Sign",          body: "Typed Data"},
+      {header: "DANGER!",       body: "YOU MUST verify this manually!!!"},
+      {header: "Domain Hash",   body: "0x" + permitDomainSeparator.toString('hex')},
+      {header: "Message Hash",  body: "0x" + messageHash.toString('hex')},
+      {header: "Are you sure?", body: "This is very dangerous!"},
+    ]);
+    expectSignedBySpeculosKey(eip712Hash(permitDomainSeparator, messageHash), dat);
+  });
+
+  it('can sign EIP-712 typed data from a streamed domain and message', async function () {
+    const path = Buffer.from('058000002c8000003c800000000000000000000000', 'hex');
+    const rv = await sendCommandAndAccept(async (eth : Eth) => {
+      await eth.transport.send(0xe0, 0x0d, 0x00, 0x00, Buffer.concat([path, Buffer.from([0x0f]), permitDomain.fields]));
+      await eth.transport.send(0xe0, 0x0d, 0x01, 0x00, permitMessage.slice(0, 96));
+      return await eth.transport.send(0xe0, 0x0d, 0x81, 0x00, permitMessage.slice(96));
+    }, [
+      {header: "Sign",            body: "Typed Data"},
+      {header: "DANGER!",         body: "YOU MUST verify this manually!!!"},
+      {header: "Domain Name",     body: "USD Coin"},
+      {header: "Domain Chain ID", body: "43114"},
+      {header: "Domain Contract", body: "0x" + permitDomain.verifyingContract},
+      {header: "Message Hash",    body: "0x" + keccak256(permitMessage).toString('hex')},
+      {header: "Are you sure?",   body: "This is very dangerous!"},
+    ]);
+    expectSignedBySpeculosKey(eip712Hash(permitDomainSeparator, keccak256(permitMessage)), {
+      v: rv[0],
+      r: rv.slice(1, 33).toString('hex'),
+      s: rv.slice(33, 65).toString('hex'),
+    });
+  });
+
   it('accepts apdu ending in the middle of parsing length of calldata', async function () {
     const transport = await transportOpen();
     await setAcceptAutomationRules();
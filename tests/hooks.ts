@@ -27,10 +27,12 @@ export const mochaHooks = {
     } else {
       if (!process.env.USE_EXISTING_SPECULOS) {
         const speculosProcessOptions: SpawnOptions = process.env.SPECULOS_DEBUG ? {stdio:"inherit"} : {};
+        const model = process.env.SPECULOS_MODEL || 'nanos';
         this.speculosProcess = spawn('speculos', [
           process.env.LEDGER_APP,
           '--display', 'headless',
-          '--sdk', '2.1',
+          '--model', model,
+          ...(model == 'nanos' ? ['--sdk', '2.1'] : []),
         ], speculosProcessOptions);
         console.log("Speculos started");
 
@@ -0,0 +1,137 @@
+// Round trip between the host encoder and the parser: encode random X-chain
+// base transactions from the codec schemas, parse them back in chunks of
+// several sizes, and check that the parser hashed every byte once and saw
+// the same amounts the encoder chose.
+
+#include "codec_encode.h"
+#include "globals.h"
+#include "hash.h"
+#include "memory.h"
+#include "network_info.h"
+#include "parser.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define TRANSACTIONS 500
+
+struct roundtrip {
+    struct codec_encoder random; // Source of the values before adjustment
+    bool inputs; // Encoding inputs rather than outputs
+    uint64_t sum_of_outputs;
+    uint64_t sum_of_inputs;
+};
+
+// Every transaction needs an input, and the first input covers all the
+// outputs so that the fee is never negative.
+static uint64_t roundtrip_value(void *const ctx, enum codec_field_kind const kind, char const *const name, uint64_t const bound) {
+    struct roundtrip *const rt = ctx;
+    uint64_t val = rt->random.value(rt->random.ctx, kind, name, bound);
+    if (kind == CODEC_ARRAY && rt->inputs && strcmp(name, "inputs") == 0) {
+        val = 1 + val % 3;
+    } else if (kind == CODEC_U64 && strcmp(name, "amount") == 0) {
+        if (!rt->inputs) {
+            rt->sum_of_outputs += val;
+        } else {
+            if (rt->sum_of_inputs == 0) val += rt->sum_of_outputs;
+            rt->sum_of_inputs += val;
+        }
+    }
+    return val;
+}
+
+static void roundtrip_bytes(void *const ctx, enum codec_field_kind const kind, char const *const name, uint8_t *const out, size_t const len) {
+    struct roundtrip *const rt = ctx;
+    rt->random.bytes(rt->random.ctx, kind, name, out, len);
+}
+
+static void put_be(uint8_t *const buf, size_t *const len, uint64_t const val, size_t const width) {
+    for (size_t i = 0; i < width; i++) {
+        buf[(*len)++] = val >> (8 * (width - 1 - i));
+    }
+}
+
+static size_t encode_base_tx(uint8_t *const buf, size_t const size, uint64_t const seed, struct roundtrip *const rt) {
+    static network_id_t const networks[] = { NETWORK_ID_MAINNET, NETWORK_ID_FUJI, NETWORK_ID_LOCAL };
+    network_info_t const *const net = network_info_from_network_id_not_null(networks[seed % NUM_ELEMENTS(networks)]);
+
+    static struct codec_random rng;
+    memset(&rng, 0, sizeof(rng));
+    rng.seed = seed;
+    memcpy(&rng.asset_id, net->avax_asset_id, sizeof(rng.asset_id));
+
+    memset(rt, 0, sizeof(*rt));
+    size_t len = 0;
+    put_be(buf, &len, 0, sizeof(uint16_t)); // codec ID
+    put_be(buf, &len, TRANSACTION_X_CHAIN_TYPE_ID_BASE, sizeof(uint32_t));
+    put_be(buf, &len, net->network_id, sizeof(uint32_t));
+    memcpy(&buf[len], &net->x_blockchain_id, sizeof(net->x_blockchain_id));
+    len += sizeof(net->x_blockchain_id);
+
+    codec_encoder_init_random(&rt->random, buf, size, &rng);
+    struct codec_encoder enc = rt->random;
+    enc.len = len;
+    enc.value = roundtrip_value;
+    enc.bytes = roundtrip_bytes;
+    enc.ctx = rt;
+
+    bool ok = codec_encode_TransferableOutputs(&enc);
+    rt->inputs = true;
+    ok = ok && codec_encode_TransferableInputs(&enc) && codec_encode_Memo(&enc);
+    if (!ok) {
+        fprintf(stderr, "seed %llu: transaction does not fit in %zu bytes\n", (unsigned long long)seed, size);
+        exit(1);
+    }
+    return enc.len;
+}
+
+static void parse_in_chunks(uint8_t const *const tx, size_t const len, size_t const chunk, uint64_t const seed, struct roundtrip const *const rt) {
+    static struct TransactionState state;
+    static parser_meta_state_t meta;
+    memset(&state, 0, sizeof(state));
+    memset(&meta, 0, sizeof(meta));
+    initTransaction(&state);
+
+    enum parse_rv rv = PARSE_RV_NEED_MORE;
+    size_t off = 0;
+    while (rv == PARSE_RV_NEED_MORE && off < len) {
+        meta.input.src = &tx[off];
+        meta.input.length = MIN(chunk, len - off);
+        meta.input.consumed = 0;
+        off += meta.input.length;
+        do {
+            memset(&meta.prompt, 0, sizeof(meta.prompt));
+            set_next_batch_size(&meta.prompt, PROMPT_MAX_BATCH_SIZE);
+            rv = parseTransaction(&state, &meta);
+        } while (rv == PARSE_RV_PROMPT);
+        if (meta.input.consumed != meta.input.length) rv = PARSE_RV_INVALID;
+    }
+
+    sign_hash_t parsed, expected;
+    finish_hash((cx_hash_t *)&state.hash_state, &parsed);
+    cx_hash_sha256(tx, len, expected, sizeof(expected));
+
+    char const *failure = NULL;
+    if (rv != PARSE_RV_DONE || off != len) failure = "parser did not finish at the end of the transaction";
+    else if (memcmp(parsed, expected, sizeof(parsed)) != 0) failure = "parser did not hash exactly the transaction bytes";
+    else if (meta.sum_of_outputs != rt->sum_of_outputs) failure = "sum of outputs differs";
+    else if (meta.sum_of_inputs != rt->sum_of_inputs) failure = "sum of inputs differs";
+    if (failure != NULL) {
+        fprintf(stderr, "seed %llu, chunk %zu: %s\n", (unsigned long long)seed, chunk, failure);
+        exit(1);
+    }
+}
+
+int main(void) {
+    static size_t const chunks[] = { 1, 7, 230 };
+    static uint8_t tx[1 << 14];
+    for (uint64_t seed = 1; seed <= TRANSACTIONS; seed++) {
+        struct roundtrip rt;
+        size_t const len = encode_base_tx(tx, sizeof(tx), seed, &rt);
+        for (size_t i = 0; i < NUM_ELEMENTS(chunks); i++) {
+            parse_in_chunks(tx, len, chunks[i], seed, &rt);
+        }
+    }
+    printf("codec round trip: %d transactions OK\n", TRANSACTIONS);
+    return 0;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+// Context and key types from the BOLOS SDK's cx.h, sized like the real ones
+// closely enough for the parser state to lay out as it does on device.
+
+#include "os.h"
+
+#define CX_APILEVEL 10
+
+#define CX_LAST (1 << 0)
+#define CX_SHA256 3
+#define CX_SHA256_SIZE 32
+#define CX_RIPEMD160_SIZE 20
+
+typedef enum { CX_CURVE_SECP256K1 } cx_curve_t;
+
+typedef struct { int algo; } cx_hash_t;
+typedef struct { cx_hash_t header; uint8_t acc[100]; } cx_sha256_t;
+typedef struct { cx_hash_t header; uint8_t acc[96]; } cx_ripemd160_t;
+typedef struct { cx_hash_t header; uint8_t acc[420]; } cx_sha3_t;
+
+typedef struct { cx_curve_t curve; size_t W_len; uint8_t W[65]; } cx_ecfp_public_key_t;
+typedef struct { cx_curve_t curve; size_t d_len; uint8_t d[32]; } cx_ecfp_private_key_t;
+
+int cx_sha256_init(cx_sha256_t *hash);
+int cx_ripemd160_init(cx_ripemd160_t *hash);
+int cx_keccak_init(cx_sha3_t *hash, size_t size);
+int cx_hash(cx_hash_t *hash, int mode, uint8_t const *in, size_t len, uint8_t *out, size_t out_len);
+int cx_hash_sha256(uint8_t const *in, size_t len, uint8_t *out, size_t out_len);
+void cx_math_mult(uint8_t *r, uint8_t const *a, uint8_t const *b, unsigned int len);
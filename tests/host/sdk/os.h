@@ -0,0 +1,38 @@
+#pragma once
+
+// Just enough of the BOLOS SDK's os.h for the parser to build on the host.
+
+#include <setjmp.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#define PRINTF(...)
+#define PIC(x) (x)
+
+typedef uint16_t exception_t;
+
+// Nothing is caught on the host: an exception ends the test run with its
+// code, so TRY bodies and FINALLY blocks simply run in order.
+void os_longjmp(unsigned int exception) __attribute__((noreturn));
+#define THROW(x) os_longjmp(x)
+#define BEGIN_TRY
+#define TRY
+#define CATCH(x) if (0)
+#define CATCH_OTHER(e) if (0) for (exception_t e = 0;;)
+#define FINALLY
+#define END_TRY
+
+#define IO_APDU_BUFFER_SIZE 260
+#define IO_SEPROXYHAL_BUFFER_SIZE_B 128
+#define IO_APDU_MEDIA_USB_HID 1
+#define CHANNEL_APDU 0
+#define IO_RETURN_AFTER_TX 0x20
+
+extern uint8_t G_io_apdu_buffer[IO_APDU_BUFFER_SIZE];
+extern int G_io_apdu_media;
+unsigned short io_exchange(unsigned char channel_and_flags, unsigned short tx_len);
+
+void explicit_bzero(void *s, size_t len);
+void nvm_write(void *dst_adr, void *src_adr, unsigned int src_len);
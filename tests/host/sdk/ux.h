@@ -0,0 +1,7 @@
+#pragma once
+
+#include "os.h"
+
+typedef struct { int unused; } ux_state_t;
+typedef struct { int unused; } bolos_ux_params_t;
+typedef struct { int unused; } bagl_element_t;